@@ -0,0 +1,84 @@
+#pragma once
+
+// Micro-benchmark framework. A benchmark body runs its work state.iterations times;
+// the runner calibrates the iteration count, warms up and then collects repeated samples.
+//
+// BENCH(hash_map_insert) {
+//     for (u64 i = 0; i < state.iterations; i++) { ... bench_do_not_optimize(result); }
+// }
+
+struct Bench_State {
+    u64 iterations;
+
+    // Bytes or items processed per iteration, reported as throughput when set
+    u64 bytes_per_iteration = 0;
+    u64 items_per_iteration = 0;
+};
+
+typedef void (*bench_fn_t)(Bench_State& state);
+
+struct Bench_Config {
+    u32 repetitions = 20;
+    u64 warmup_ns = 100 * 1000000ull;
+    u64 min_sample_ns = 10 * 1000000ull;
+
+    // -1 to not pin the benchmark thread
+    s32 cpu = -1;
+
+    str_ptr_t filter = NULL;
+    str_ptr_t json_path = NULL;
+};
+
+struct Bench_Result {
+    str_ptr_t name;
+    u64 iterations_per_sample;
+    u32 samples;
+
+    // Nanoseconds per iteration
+    f64 min;
+    f64 max;
+    f64 mean;
+    f64 median;
+    f64 stddev;
+
+    u64 bytes_per_iteration;
+    u64 items_per_iteration;
+};
+
+struct Bench_Registrar {
+    Bench_Registrar(str_ptr_t name, bench_fn_t fn);
+};
+
+#define BENCH(name) \
+    static void bench_##name(Bench_State& state); \
+    static Bench_Registrar __bench_registrar_##name(#name, bench_##name); \
+    static void bench_##name(Bench_State& state)
+
+// Runs every registered benchmark matching config.filter, returns the number of benchmarks run
+u32 run_benchmarks(const Bench_Config& config);
+
+void list_benchmarks();
+
+// Keeps the compiler from optimizing away a value or the stores before this point
+#if defined(__GNUC__) || defined(__clang__)
+    template <typename T>
+    _st_force_inline void bench_do_not_optimize(T const& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+    _st_force_inline void bench_clobber_memory() {
+        asm volatile("" : : : "memory");
+    }
+#else
+    #include <intrin.h>
+    
+    void _bench_use_pointer(const volatile void* ptr);
+
+    template <typename T>
+    _st_force_inline void bench_do_not_optimize(T const& value) {
+        _bench_use_pointer(&value);
+        _ReadWriteBarrier();
+    }
+    _st_force_inline void bench_clobber_memory() {
+        _ReadWriteBarrier();
+    }
+#endif
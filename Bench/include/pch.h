@@ -0,0 +1,3 @@
+#pragma once
+
+#include "Engine/pch.h"
\ No newline at end of file
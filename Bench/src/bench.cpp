@@ -0,0 +1,167 @@
+#include "pch.h"
+
+#include "bench.h"
+
+#include "Engine/json.h"
+
+#include <chrono>
+#include <algorithm>
+#include <math.h>
+
+#ifdef _ST_OS_WINDOWS
+    #include "Windows.h"
+#else
+    #include <sched.h>
+    #include <pthread.h>
+#endif
+
+struct Bench_Entry {
+    str_ptr_t name;
+    bench_fn_t fn;
+};
+
+// Function local so registration from static initializers in other translation units is safe
+static std::vector<Bench_Entry>& get_benchmarks() {
+    static std::vector<Bench_Entry> benchmarks;
+    return benchmarks;
+}
+
+Bench_Registrar::Bench_Registrar(str_ptr_t name, bench_fn_t fn) {
+    get_benchmarks().push_back({ name, fn });
+}
+
+#if !defined(__GNUC__) && !defined(__clang__)
+void _bench_use_pointer(const volatile void*) {}
+#endif
+
+static u64 now_ns() {
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool pin_thread(s32 cpu) {
+#ifdef _ST_OS_WINDOWS
+    return SetThreadAffinityMask(GetCurrentThread(), 1ull << cpu) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+static u64 run_sample(bench_fn_t fn, Bench_State& state) {
+    const u64 begin = now_ns();
+    fn(state);
+    return now_ns() - begin;
+}
+
+static Bench_Result run_benchmark(const Bench_Entry& entry, const Bench_Config& config, std::vector<f64>& samples) {
+    Bench_State state;
+    state.iterations = 1;
+
+    // Grow the iteration count until a sample takes long enough to time reliably
+    u64 elapsed = run_sample(entry.fn, state);
+    while (elapsed < config.min_sample_ns && state.iterations < (1ull << 40)) {
+        const u64 scale = elapsed > 0 ? (config.min_sample_ns * 12 / 10) / elapsed : 10;
+        state.iterations *= scale < 2 ? 2 : (scale > 10 ? 10 : scale);
+        elapsed = run_sample(entry.fn, state);
+    }
+
+    const u64 warmup_begin = now_ns();
+    while (now_ns() - warmup_begin < config.warmup_ns) {
+        run_sample(entry.fn, state);
+    }
+
+    samples.clear();
+    for (u32 i = 0; i < config.repetitions; i++) {
+        samples.push_back((f64)run_sample(entry.fn, state) / state.iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Bench_Result result = {};
+    result.name = entry.name;
+    result.iterations_per_sample = state.iterations;
+    result.samples = (u32)samples.size();
+    result.bytes_per_iteration = state.bytes_per_iteration;
+    result.items_per_iteration = state.items_per_iteration;
+    result.min = samples.front();
+    result.max = samples.back();
+
+    const size_t mid = samples.size() / 2;
+    result.median = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) / 2.0;
+
+    for (f64 sample : samples) result.mean += sample;
+    result.mean /= samples.size();
+    for (f64 sample : samples) result.stddev += (sample - result.mean) * (sample - result.mean);
+    result.stddev = samples.size() > 1 ? sqrt(result.stddev / (samples.size() - 1)) : 0.0;
+
+    return result;
+}
+
+static bool write_json(str_ptr_t path, const Bench_Config& config, const std::vector<Bench_Result>& results) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    fmt::memory_buffer buf;
+    fmt::format_to(std::back_inserter(buf), "{{\"repetitions\":{},\"cpu\":{},\"benchmarks\":[", config.repetitions, config.cpu);
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        if (i > 0) buf.push_back(',');
+        json_append_raw(buf, "\n{\"name\":");
+        json_append_string(buf, result.name);
+        fmt::format_to(std::back_inserter(buf), 
+            ",\"iterations\":{},\"samples\":{},\"min_ns\":{:.3f},\"max_ns\":{:.3f},\"mean_ns\":{:.3f},\"median_ns\":{:.3f},\"stddev_ns\":{:.3f},\"bytes_per_iteration\":{},\"items_per_iteration\":{}}}",
+            result.iterations_per_sample, result.samples, result.min, result.max, result.mean, result.median, result.stddev, 
+            result.bytes_per_iteration, result.items_per_iteration);
+    }
+    json_append_raw(buf, "\n]}\n");
+
+    const bool ok = fwrite(buf.data(), 1, buf.size(), file) == buf.size();
+    fclose(file);
+    return ok;
+}
+
+static bool matches_filter(str_ptr_t name, str_ptr_t filter) {
+    return !filter || strstr(name, filter) != NULL;
+}
+
+u32 run_benchmarks(const Bench_Config& config) {
+    if (config.cpu >= 0 && !pin_thread(config.cpu)) {
+        printf("Could not pin the benchmark thread to CPU %d\n", config.cpu);
+    }
+
+    printf("%-40s %14s %14s %14s %10s %14s\n", "Benchmark", "median ns", "min ns", "mean ns", "cv %", "throughput");
+
+    std::vector<Bench_Result> results;
+    std::vector<f64> samples;
+    samples.reserve(config.repetitions);
+
+    for (const auto& entry : get_benchmarks()) {
+        if (!matches_filter(entry.name, config.filter)) continue;
+
+        const auto result = run_benchmark(entry, config, samples);
+        results.push_back(result);
+
+        str64_t throughput = "";
+        if (result.bytes_per_iteration) {
+            snprintf(throughput, sizeof(throughput), "%.2f MiB/s", result.bytes_per_iteration / result.median * 1e9 / (1024.0 * 1024.0));
+        } else if (result.items_per_iteration) {
+            snprintf(throughput, sizeof(throughput), "%.2f M/s", result.items_per_iteration / result.median * 1e3);
+        }
+
+        printf("%-40s %14.2f %14.2f %14.2f %10.2f %14s\n", result.name, result.median, result.min, result.mean, 
+            result.mean > 0 ? result.stddev / result.mean * 100.0 : 0.0, throughput);
+    }
+
+    if (config.json_path && !write_json(config.json_path, config, results)) {
+        printf("Could not write results to '%s'\n", config.json_path);
+    }
+
+    return (u32)results.size();
+}
+
+void list_benchmarks() {
+    for (const auto& entry : get_benchmarks()) {
+        printf("%s\n", entry.name);
+    }
+}
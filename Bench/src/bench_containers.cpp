@@ -0,0 +1,112 @@
+#include "pch.h"
+
+#include "bench.h"
+
+#define BENCH_CONTAINER_SIZE 4096
+
+// Deterministic keys so every run does the same work
+static u64 bench_key(u64 i) {
+    return (i * 0x9E3779B97F4A7C15ull) >> 16;
+}
+
+BENCH(hash_map_insert) {
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    for (u64 i = 0; i < state.iterations; i++) {
+        Hash_Map<u64, u64> map;
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) map[bench_key(j)] = j;
+        bench_do_not_optimize(map);
+    }
+}
+
+BENCH(hash_map_find) {
+    Hash_Map<u64, u64> map;
+    for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) map[bench_key(j)] = j;
+
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    for (u64 i = 0; i < state.iterations; i++) {
+        u64 sum = 0;
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) sum += map.find(bench_key(j))->second;
+        bench_do_not_optimize(sum);
+    }
+}
+
+BENCH(ordered_map_insert) {
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    for (u64 i = 0; i < state.iterations; i++) {
+        Ordered_Map<u64, u64> map;
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) map[bench_key(j)] = j;
+        bench_do_not_optimize(map);
+    }
+}
+
+BENCH(ordered_map_find) {
+    Ordered_Map<u64, u64> map;
+    for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) map[bench_key(j)] = j;
+
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    for (u64 i = 0; i < state.iterations; i++) {
+        u64 sum = 0;
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) sum += map.find(bench_key(j))->second;
+        bench_do_not_optimize(sum);
+    }
+}
+
+BENCH(hash_set_insert) {
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    for (u64 i = 0; i < state.iterations; i++) {
+        Hash_Set<u64> set;
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) set.insert(bench_key(j));
+        bench_do_not_optimize(set);
+    }
+}
+
+BENCH(ordered_set_insert) {
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    for (u64 i = 0; i < state.iterations; i++) {
+        Ordered_Set<u64> set;
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) set.insert(bench_key(j));
+        bench_do_not_optimize(set);
+    }
+}
+
+BENCH(deque_push_pop) {
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    Deque<u64> deque;
+    for (u64 i = 0; i < state.iterations; i++) {
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) deque.push_back(j);
+        u64 sum = 0;
+        while (!deque.empty()) {
+            sum += deque.front();
+            deque.pop_front();
+        }
+        bench_do_not_optimize(sum);
+    }
+}
+
+BENCH(queue_push_pop) {
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    Queue<u64> queue;
+    for (u64 i = 0; i < state.iterations; i++) {
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) queue.push(j);
+        u64 sum = 0;
+        while (!queue.empty()) {
+            sum += queue.front();
+            queue.pop();
+        }
+        bench_do_not_optimize(sum);
+    }
+}
+
+BENCH(stack_push_pop) {
+    state.items_per_iteration = BENCH_CONTAINER_SIZE;
+    Stack<u64> stack;
+    for (u64 i = 0; i < state.iterations; i++) {
+        for (u64 j = 0; j < BENCH_CONTAINER_SIZE; j++) stack.push(j);
+        u64 sum = 0;
+        while (!stack.empty()) {
+            sum += stack.top();
+            stack.pop();
+        }
+        bench_do_not_optimize(sum);
+    }
+}
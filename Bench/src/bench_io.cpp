@@ -0,0 +1,89 @@
+#include "pch.h"
+
+#include "bench.h"
+
+#include "os/io.h"
+#include "os/directory_scanner.h"
+
+#include <filesystem>
+
+BENCH(io_get_directory) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        New_String dir = os::io::get_directory("assets/levels/forest/chunks/chunk_0042/terrain.raw");
+        bench_do_not_optimize(dir.str);
+    }
+}
+
+BENCH(io_get_exe_dir) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        New_String dir = os::io::get_exe_dir();
+        bench_do_not_optimize(dir.str);
+    }
+}
+
+BENCH(io_get_cached_exe_dir) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        bench_do_not_optimize(os::io::get_cached_exe_dir());
+    }
+}
+
+BENCH(io_path_directory) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        std::string_view dir = os::io::path_directory("assets/levels/forest/chunks/chunk_0042/terrain.raw");
+        bench_do_not_optimize(dir.data());
+    }
+}
+
+BENCH(io_path_join_normalize) {
+    path_str_t path;
+    for (u64 i = 0; i < state.iterations; i++) {
+        os::io::path_join(path, "assets/levels/forest/", "../shared/./textures/bark.png");
+        os::io::path_normalize(path, path);
+        bench_do_not_optimize(path);
+    }
+}
+
+BENCH(io_path_relative) {
+    path_str_t path;
+    for (u64 i = 0; i < state.iterations; i++) {
+        os::io::path_relative(path, "assets/shared/textures/bark.png", "assets/levels/forest");
+        bench_do_not_optimize(path);
+    }
+}
+
+BENCH(io_path_relative_absolute) {
+    path_str_t path;
+    for (u64 i = 0; i < state.iterations; i++) {
+        os::io::path_relative(path, "/home/user/project/assets/shared/bark.png", "/home/user/project/bin/Debug");
+        bench_do_not_optimize(path);
+    }
+}
+
+// Both scan the directory the bench runs from, entries per second are comparable
+BENCH(io_dir_scan) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        os::io::Dir_Scan scan(".", os::io::DIR_SCAN_RECURSIVE);
+        state.items_per_iteration = scan.entry_count;
+        bench_do_not_optimize(scan.entries);
+    }
+}
+
+BENCH(io_dir_scan_stat) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        os::io::Dir_Scan scan(".", os::io::DIR_SCAN_RECURSIVE | os::io::DIR_SCAN_STAT);
+        state.items_per_iteration = scan.entry_count;
+        bench_do_not_optimize(scan.entries);
+    }
+}
+
+BENCH(io_filesystem_iterate) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        std::error_code error;
+        u64 count = 0;
+        for (auto it = std::filesystem::recursive_directory_iterator(".", error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            bench_do_not_optimize(it->path().native().data());
+            count++;
+        }
+        state.items_per_iteration = count;
+    }
+}
@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "bench.h"
+
+#include "Engine/logger.h"
+
+#include <spdlog/sinks/ostream_sink.h>
+
+// Discards output while still going through the whole formatting and stream path
+class Null_Stream_Buffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+Null_Stream_Buffer bench_null_buffer;
+std::ostream bench_null_stream(&bench_null_buffer);
+
+struct Bench_Log_Sink {
+    spdlog::sink_ptr sink;
+
+    Bench_Log_Sink(spdlog::level::level_enum level) {
+        sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(bench_null_stream, false);
+        sink->set_level(level);
+        add_log_sink(sink);
+    }
+    ~Bench_Log_Sink() {
+        remove_log_sink(sink);
+    }
+};
+
+BENCH(log_filtered_out) {
+    set_log_ring_level(spdlog::level::off);
+    for (u64 i = 0; i < state.iterations; i++) {
+        log_trace("Filtered message {} {}", i, 3.5f);
+    }
+    set_log_ring_level(spdlog::level::trace);
+}
+
+BENCH(log_ring_only) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        log_info("Ring message {} {}", i, 3.5f);
+    }
+}
+
+BENCH(log_stream_sink) {
+    Bench_Log_Sink sink(spdlog::level::trace);
+    for (u64 i = 0; i < state.iterations; i++) {
+        log_info("Stream message {} {}", i, 3.5f);
+    }
+}
+
+BENCH(log_structured) {
+    Bench_Log_Sink sink(spdlog::level::trace);
+    for (u64 i = 0; i < state.iterations; i++) {
+        log_info_kv("Structured message", {"index", i}, {"value", 3.5f}, {"name", "player"});
+    }
+}
+
+BENCH(log_every_n_suppressed) {
+    Bench_Log_Sink sink(spdlog::level::trace);
+    for (u64 i = 0; i < state.iterations; i++) {
+        log_info_every_n(1000000000, "Rate limited message {}", i);
+    }
+}
+
+BENCH(log_channel_disabled) {
+    set_log_channel_level(LOG_CHANNEL_RENDER, spdlog::level::off);
+    for (u64 i = 0; i < state.iterations; i++) {
+        log_trace_ch(LOG_CHANNEL_RENDER, "Channel message {}", i);
+    }
+}
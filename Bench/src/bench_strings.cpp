@@ -0,0 +1,55 @@
+#include "pch.h"
+
+#include "bench.h"
+
+str_ptr_t bench_short_string = "textures/player.png";
+str_ptr_t bench_long_string = "assets/levels/forest/chunks/chunk_0042/terrain/heightmaps/heightmap_lod0_normalized_final.raw";
+
+BENCH(new_string_short) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        New_String str(bench_short_string);
+        bench_do_not_optimize(str.str);
+    }
+}
+
+BENCH(new_string_long) {
+    for (u64 i = 0; i < state.iterations; i++) {
+        New_String str(bench_long_string);
+        bench_do_not_optimize(str.str);
+    }
+}
+
+BENCH(new_string_copy) {
+    New_String src(bench_long_string);
+    for (u64 i = 0; i < state.iterations; i++) {
+        New_String str(src);
+        bench_do_not_optimize(str.str);
+    }
+}
+
+BENCH(new_string_equals) {
+    New_String a(bench_long_string);
+    New_String b(bench_long_string);
+    for (u64 i = 0; i < state.iterations; i++) {
+        bool equal = a.equals(b);
+        bench_do_not_optimize(equal);
+    }
+}
+
+BENCH(new_string_len) {
+    New_String str(bench_long_string);
+    for (u64 i = 0; i < state.iterations; i++) {
+        size_t len = str.len();
+        bench_do_not_optimize(len);
+        bench_clobber_memory();
+    }
+}
+
+BENCH(dynamic_string_append) {
+    state.items_per_iteration = 64;
+    for (u64 i = 0; i < state.iterations; i++) {
+        Dynamic_String str;
+        for (u32 j = 0; j < 64; j++) str += "segment/";
+        bench_do_not_optimize(str);
+    }
+}
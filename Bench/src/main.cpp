@@ -0,0 +1,63 @@
+#include "pch.h"
+
+#include "bench.h"
+
+#include "Engine/logger.h"
+
+static void print_usage() {
+    printf(
+        "Usage: Bench [options]\n"
+        "  --filter <text>     Only run benchmarks whose name contains text\n"
+        "  --json <path>       Write results as JSON\n"
+        "  --cpu <n>           Pin the benchmark thread to CPU n\n"
+        "  --repetitions <n>   Samples per benchmark (default 20)\n"
+        "  --warmup-ms <n>     Warmup time per benchmark (default 100)\n"
+        "  --min-sample-ms <n> Minimum duration of one sample (default 10)\n"
+        "  --list              List benchmarks and exit\n");
+}
+
+std::ofstream log_stream;
+int main(int argc, char** argv) {
+    Bench_Config config;
+
+    for (int i = 1; i < argc; i++) {
+        str_ptr_t arg = argv[i];
+        str_ptr_t value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--list") == 0) {
+            list_benchmarks();
+            return 0;
+        } else if (strcmp(arg, "--help") == 0) {
+            print_usage();
+            return 0;
+        } else if (!value) {
+            print_usage();
+            return 1;
+        } else if (strcmp(arg, "--filter") == 0) {
+            config.filter = value;
+        } else if (strcmp(arg, "--json") == 0) {
+            config.json_path = value;
+        } else if (strcmp(arg, "--cpu") == 0) {
+            config.cpu = atoi(value);
+        } else if (strcmp(arg, "--repetitions") == 0) {
+            config.repetitions = (u32)atoi(value);
+        } else if (strcmp(arg, "--warmup-ms") == 0) {
+            config.warmup_ns = strtoull(value, NULL, 10) * 1000000ull;
+        } else if (strcmp(arg, "--min-sample-ms") == 0) {
+            config.min_sample_ns = strtoull(value, NULL, 10) * 1000000ull;
+        } else {
+            print_usage();
+            return 1;
+        }
+        i++;
+    }
+
+    if (config.repetitions == 0) config.repetitions = 1;
+
+    // The logger benchmarks attach their own sinks, keep the default ones quiet
+    log_stream.open("bench_log");
+    init_logger(log_stream);
+    set_logger_level(spdlog::level::off);
+
+    return run_benchmarks(config) > 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "os/io.h"
+
+// On-disk cache of processed assets (decoded images, resampled audio). Entries are keyed by the
+// source content together with the importer and its settings, so editing a source or a setting
+// simply misses and a stale output is never returned. Outputs are stored ready to be mapped and
+// used in place, a hit costs an open and an mmap.
+
+#define ASSET_CACHE_MAGIC   0x43415453 // "STAC"
+#define ASSET_CACHE_VERSION 1
+
+// Outputs start at this offset in their file, aligned for SIMD access from the mapping
+#define ASSET_CACHE_DATA_OFFSET 64
+
+struct Asset_Cache_Header {
+    u32 magic;
+    u32 version;
+    u64 key;
+    u64 size;
+};
+
+typedef u64 asset_key_t;
+
+// settings is hashed as raw bytes, keep it free of padding. Bump importer_version whenever the
+// importer's output changes.
+asset_key_t ST_API asset_cache_key(const void* source, size_t source_size, str_ptr_t importer, u32 importer_version,
+    const void* settings = NULL, size_t settings_size = 0);
+
+// Creates the directory if needed. Without a cache every lookup misses and stores are dropped.
+bool ST_API init_asset_cache(str_ptr_t directory);
+void ST_API shutdown_asset_cache();
+bool ST_API asset_cache_enabled();
+
+// Read-only view of a cached output, data points into the mapping
+struct ST_API Asset_Cache_Entry {
+
+    Asset_Cache_Entry() = default;
+    Asset_Cache_Entry(Asset_Cache_Entry&& other);
+    Asset_Cache_Entry& operator=(Asset_Cache_Entry&& other);
+    ~Asset_Cache_Entry();
+
+    Asset_Cache_Entry(const Asset_Cache_Entry&) = delete;
+    Asset_Cache_Entry& operator=(const Asset_Cache_Entry&) = delete;
+
+    const byte_t* data = NULL;
+    size_t size = 0;
+
+    // IO_STATUS_FILE_NOT_FOUND on a miss
+    os::io::Io_Status _status = os::io::IO_STATUS_UNSET;
+
+    os::io::Mapped_File* __mapping = NULL;
+};
+
+Asset_Cache_Entry ST_API asset_cache_load(asset_key_t key);
+
+// Written atomically, a crash never leaves a partial entry behind
+bool ST_API asset_cache_store(asset_key_t key, const void* data, size_t size);
@@ -111,8 +111,10 @@
 #define NS_END(x) }
 
 #ifdef _ST_OS_WINDOWS
+	#define MODULE_FILE_PREFIX ""
 	#define MODULE_FILE_EXTENSION "dll"
-#elif defined(_OS_LINUX)
+#elif defined(_ST_OS_LINUX)
+	#define MODULE_FILE_PREFIX "lib"
 	#define MODULE_FILE_EXTENSION "so"
 #endif
 
@@ -0,0 +1,108 @@
+#pragma once
+
+// Non-cryptographic hashes. Values end up on disk (pack indices), don't change them.
+
+#define FNV1A_64_OFFSET 0xcbf29ce484222325ull
+#define FNV1A_64_PRIME  0x100000001b3ull
+
+constexpr u64 fnv1a_64(const void* data, size_t len, u64 hash = FNV1A_64_OFFSET) {
+    const byte_t* bytes = (const byte_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= FNV1A_64_PRIME;
+    }
+    return hash;
+}
+
+inline u64 fnv1a_64(str_ptr_t str, u64 hash = FNV1A_64_OFFSET) {
+    return fnv1a_64(str, strlen(str), hash);
+}
+
+// XXH64, for bulk data where fnv1a_64 is too slow. Matches the reference implementation.
+
+#define XXH64_PRIME_1 0x9E3779B185EBCA87ull
+#define XXH64_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define XXH64_PRIME_3 0x165667B19E3779F9ull
+#define XXH64_PRIME_4 0x85EBCA77C2B2AE63ull
+#define XXH64_PRIME_5 0x27D4EB2F165667C5ull
+
+_st_force_inline u64 _xxh64_rotl(u64 x, u32 r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+_st_force_inline u64 _xxh64_read64(const byte_t* p) {
+    u64 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+_st_force_inline u32 _xxh64_read32(const byte_t* p) {
+    u32 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+_st_force_inline u64 _xxh64_round(u64 acc, u64 input) {
+    acc += input * XXH64_PRIME_2;
+    acc = _xxh64_rotl(acc, 31);
+    return acc * XXH64_PRIME_1;
+}
+
+_st_force_inline u64 _xxh64_merge_round(u64 acc, u64 value) {
+    acc ^= _xxh64_round(0, value);
+    return acc * XXH64_PRIME_1 + XXH64_PRIME_4;
+}
+
+// Assumes a little endian target like everything else that reads these from disk
+inline u64 xxh64(const void* data, size_t len, u64 seed = 0) {
+    const byte_t* p = (const byte_t*)data;
+    const byte_t* const end = p + len;
+    u64 hash;
+
+    if (len >= 32) {
+        u64 v1 = seed + XXH64_PRIME_1 + XXH64_PRIME_2;
+        u64 v2 = seed + XXH64_PRIME_2;
+        u64 v3 = seed;
+        u64 v4 = seed - XXH64_PRIME_1;
+
+        const byte_t* const limit = end - 32;
+        do {
+            v1 = _xxh64_round(v1, _xxh64_read64(p));
+            v2 = _xxh64_round(v2, _xxh64_read64(p + 8));
+            v3 = _xxh64_round(v3, _xxh64_read64(p + 16));
+            v4 = _xxh64_round(v4, _xxh64_read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = _xxh64_rotl(v1, 1) + _xxh64_rotl(v2, 7) + _xxh64_rotl(v3, 12) + _xxh64_rotl(v4, 18);
+        hash = _xxh64_merge_round(hash, v1);
+        hash = _xxh64_merge_round(hash, v2);
+        hash = _xxh64_merge_round(hash, v3);
+        hash = _xxh64_merge_round(hash, v4);
+    } else {
+        hash = seed + XXH64_PRIME_5;
+    }
+
+    hash += (u64)len;
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= _xxh64_round(0, _xxh64_read64(p));
+        hash = _xxh64_rotl(hash, 27) * XXH64_PRIME_1 + XXH64_PRIME_4;
+    }
+    if (p + 4 <= end) {
+        hash ^= (u64)_xxh64_read32(p) * XXH64_PRIME_1;
+        hash = _xxh64_rotl(hash, 23) * XXH64_PRIME_2 + XXH64_PRIME_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        hash ^= (u64)*p * XXH64_PRIME_5;
+        hash = _xxh64_rotl(hash, 11) * XXH64_PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH64_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= XXH64_PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
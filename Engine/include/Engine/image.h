@@ -0,0 +1,35 @@
+#pragma once
+
+#include "asset_cache.h"
+
+struct Image_Import_Settings {
+    // 1 to 4, 0 keeps the channel count of the source
+    u32 channels = 4;
+    u32 flip_vertically = 0;
+};
+
+// 8 bit per channel pixels, rows tightly packed. Images that came from the asset cache point
+// into its mapping, freshly decoded ones own their pixels.
+struct ST_API Image {
+
+    Image() = default;
+    Image(Image&& other);
+    Image& operator=(Image&& other);
+    ~Image();
+
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    const byte_t* pixels = NULL;
+    u32 width = 0;
+    u32 height = 0;
+    u32 channels = 0;
+
+    os::io::Io_Status _status = os::io::IO_STATUS_UNSET;
+
+    Asset_Cache_Entry __cached;
+    byte_t* __decoded = NULL;
+};
+
+// Decodes an image from the VFS, or maps the output of an earlier decode from the asset cache
+Image ST_API load_image(str_ptr_t path, const Image_Import_Settings& settings = {});
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <spdlog/fmt/fmt.h>
+
+#include <math.h>
+
+// Minimal JSON writing helpers appending straight into a fmt memory buffer
+
+template <typename Buffer>
+inline void json_append_raw(Buffer& buf, str_ptr_t str) {
+    buf.append(str, str + strlen(str));
+}
+
+template <typename Buffer>
+inline void json_append_string(Buffer& buf, const char* str, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+
+    buf.push_back('"');
+    for (size_t i = 0; i < len; i++) {
+        const char c = str[i];
+        switch (c) {
+            case '"':  json_append_raw(buf, "\\\""); break;
+            case '\\': json_append_raw(buf, "\\\\"); break;
+            case '\n': json_append_raw(buf, "\\n"); break;
+            case '\r': json_append_raw(buf, "\\r"); break;
+            case '\t': json_append_raw(buf, "\\t"); break;
+            default:
+                if ((u8)c < 0x20) {
+                    const char escaped[] = { '\\', 'u', '0', '0', hex[(u8)c >> 4], hex[(u8)c & 0xf] };
+                    buf.append(escaped, escaped + sizeof(escaped));
+                } else {
+                    buf.push_back(c);
+                }
+                break;
+        }
+    }
+    buf.push_back('"');
+}
+
+template <typename Buffer>
+inline void json_append_string(Buffer& buf, str_ptr_t str) {
+    json_append_string(buf, str, strlen(str));
+}
+
+// Appends "key":
+template <typename Buffer>
+inline void json_append_key(Buffer& buf, str_ptr_t key) {
+    json_append_string(buf, key);
+    buf.push_back(':');
+}
+
+template <typename Buffer>
+inline void json_append_number(Buffer& buf, f64 value) {
+    if (isfinite(value)) fmt::format_to(std::back_inserter(buf), "{}", value);
+    else json_append_raw(buf, "null");
+}
+
+template <typename Buffer>
+inline void json_append_number(Buffer& buf, s64 value) {
+    fmt::format_to(std::back_inserter(buf), "{}", value);
+}
+
+template <typename Buffer>
+inline void json_append_number(Buffer& buf, u64 value) {
+    fmt::format_to(std::back_inserter(buf), "{}", value);
+}
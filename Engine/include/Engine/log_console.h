@@ -0,0 +1,62 @@
+#pragma once
+
+#include <spdlog/common.h>
+
+#include "profiled_mutex.h"
+
+struct ImVec4;
+
+struct Log_Console_Entry {
+    u64 offset; // Position in the arena stream, the text lives at arena[offset % arena_size]
+    u32 len;
+    spdlog::level::level_enum level;
+};
+
+// Log viewer backend. Text is stored in one contiguous arena and indexed by a fixed ring of
+// entries; the oldest entries are evicted when either is full. Only the visible rows are rendered.
+struct ST_API Log_Console {
+
+    Log_Console(size_t arena_size = 16 * 1024 * 1024, size_t max_entries = 256 * 1024);
+    ~Log_Console();
+
+    Log_Console(const Log_Console&) = delete;
+    Log_Console& operator=(const Log_Console&) = delete;
+
+    // Thread safe
+    void push(spdlog::level::level_enum level, const char* text, size_t len);
+    void clear();
+
+    void set_filter(spdlog::level::level_enum level, bool show);
+
+    void do_gui(str_ptr_t title = "Log", bool* open = NULL);
+
+    size_t entry_count() const { return (size_t)(_next_seq - _first_seq); }
+
+    bool auto_scroll = true;
+
+    char* _arena = NULL;
+    size_t _arena_size;
+    u64 _write_pos = 0;
+
+    Log_Console_Entry* _entries = NULL;
+    size_t _max_entries;
+    u64 _first_seq = 0;
+    u64 _next_seq = 0;
+
+    // Sequence numbers of entries passing the filter, appended to as new entries arrive
+    Deque<u64> _filtered;
+    u64 _filtered_until = 0;
+    bool _filter_flags[spdlog::level::n_levels];
+    bool _filter_dirty = false;
+    bool _has_new = false;
+
+    ImVec4* _filter_colors = NULL;
+
+    // Rows copied out of the arena for the current frame, offsets index _visible_text
+    std::vector<Log_Console_Entry> _visible;
+    std::vector<char> _visible_text;
+
+    spdlog::sink_ptr _sink;
+
+    Profiled_Mutex _mutex{"log console"};
+};
@@ -2,14 +2,138 @@
 
 #include <spdlog/spdlog.h>
 
+#include <initializer_list>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+
 struct Gui_Window;
 
-void ST_API init_logger(std::ostream& ostr);
+// json_ostr, if given, receives every message as one JSON object per line (JSON Lines)
+void ST_API init_logger(std::ostream& ostr, std::ostream* json_ostr = NULL);
 
+// Sets the level of the stream and stdout sinks. The crash ring keeps its own level.
 void ST_API set_logger_level(spdlog::level::level_enum level);
 
+// Sets the level of messages kept in the in-memory crash ring (trace by default)
+void ST_API set_log_ring_level(spdlog::level::level_enum level);
+
+// Attaches an additional sink (e.g. a Log_Console) which keeps its own level
+void ST_API add_log_sink(spdlog::sink_ptr sink);
+void ST_API remove_log_sink(spdlog::sink_ptr sink);
+
+// Writes the messages kept in the crash ring to fd, oldest first.
+// Does not allocate or lock so it can be called from a fatal signal handler.
+void ST_API dump_log_ring(int fd);
+
 std::shared_ptr<spdlog::logger> ST_API _get_spdlogger();
 
+// Channels are named loggers with their own level and sinks, e.g. "render", "io", "module:Sandbox".
+// By default a channel routes into the same sinks as the main logger. A message has to pass both the
+// channel level and the sink's level, set with set_logger_level, set_log_ring_level or on sinks
+// attached with add_log_sink.
+typedef u8 log_channel_t;
+
+enum : log_channel_t {
+    LOG_CHANNEL_RENDER,
+    LOG_CHANNEL_AUDIO,
+    LOG_CHANNEL_IO,
+
+    LOG_CHANNEL_BUILTIN_COUNT,
+
+    LOG_CHANNEL_INVALID = 0xFF
+};
+
+#define MAX_LOG_CHANNELS 64
+
+// Bit n of _log_channel_masks[level] is set if channel n is enabled for level
+extern ST_API std::atomic<u64> _log_channel_masks[spdlog::level::n_levels];
+
+// Returns the existing channel if one with the same name is already registered
+log_channel_t ST_API register_log_channel(str_ptr_t name, spdlog::level::level_enum level = spdlog::level::info);
+log_channel_t ST_API find_log_channel(str_ptr_t name);
+
+void ST_API set_log_channel_level(log_channel_t channel, spdlog::level::level_enum level);
+
+// Routes the channel to an additional sink / replaces the channel's sinks entirely
+void ST_API add_log_channel_sink(log_channel_t channel, spdlog::sink_ptr sink);
+void ST_API set_log_channel_sinks(log_channel_t channel, std::vector<spdlog::sink_ptr> sinks);
+
+// Applies a "name=level,name=level" spec, e.g. "io=trace,render=warn,module:Sandbox=debug".
+// init_logger applies the ST_LOG_CHANNELS environment variable through this.
+void ST_API configure_log_channels(str_ptr_t spec);
+
+spdlog::logger* ST_API _get_channel_logger(log_channel_t channel);
+
+// LOG_CHANNEL_INVALID (a failed registration) is never enabled
+#define _log_channel_enabled(channel, level) ((channel) < MAX_LOG_CHANNELS && ((_log_channel_masks[level].load(std::memory_order_relaxed) >> (channel)) & 1))
+
+// The mask test happens before any of the arguments are evaluated
+#define log_channel(channel, level, ...) { if (_log_channel_enabled(channel, level)) SPDLOG_LOGGER_CALL(_get_channel_logger(channel), level, __VA_ARGS__); }
+
+enum Log_Field_Type : u8 {
+    LOG_FIELD_INT,
+    LOG_FIELD_UINT,
+    LOG_FIELD_FLOAT,
+    LOG_FIELD_BOOL,
+    LOG_FIELD_STRING,
+};
+
+// Typed key/value attached to a structured log message. Strings are not copied, so
+// fields are only valid for the duration of the log call.
+struct Log_Field {
+    str_ptr_t key;
+    Log_Field_Type type;
+    union {
+        s64 i;
+        u64 u;
+        f64 f;
+        bool b;
+        str_ptr_t s;
+    };
+
+    Log_Field(str_ptr_t key, bool value) : key(key), type(LOG_FIELD_BOOL), b(value) {}
+    Log_Field(str_ptr_t key, str_ptr_t value) : key(key), type(LOG_FIELD_STRING), s(value) {}
+    Log_Field(str_ptr_t key, const Dynamic_String& value) : key(key), type(LOG_FIELD_STRING), s(value.c_str()) {}
+
+    template <typename T> requires (std::is_integral_v<T> && std::is_signed_v<T> && !std::is_same_v<T, bool>)
+    Log_Field(str_ptr_t key, T value) : key(key), type(LOG_FIELD_INT), i(value) {}
+
+    template <typename T> requires (std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>)
+    Log_Field(str_ptr_t key, T value) : key(key), type(LOG_FIELD_UINT), u(value) {}
+
+    template <typename T> requires std::is_floating_point_v<T>
+    Log_Field(str_ptr_t key, T value) : key(key), type(LOG_FIELD_FLOAT), f(value) {}
+};
+
+// Text sinks get "msg key=value ...", the JSON Lines sink gets the fields as typed JSON members
+void ST_API _log_structured(spdlog::level::level_enum level, str_ptr_t msg, std::initializer_list<Log_Field> fields);
+
+// Fields are only evaluated if the level is enabled
+#define _log_kv(level, msg, ...) { if (_get_spdlogger()->should_log(level)) _log_structured(level, msg, { __VA_ARGS__ }); }
+
+// Rate limiting state lives in statics at each call site. Suppressed calls cost one relaxed atomic
+// operation (plus a steady clock read for the time window variant) and never evaluate arguments.
+
+// n of 0 logs every call like n of 1
+#define _log_every_n(log_macro, n, ...) { \
+    static std::atomic<u64> __st_log_hits = 0; \
+    const u64 __st_log_n = (u64)(n); \
+    if (__st_log_hits.fetch_add(1, std::memory_order_relaxed) % (__st_log_n ? __st_log_n : 1) == 0) log_macro(__VA_ARGS__) \
+}
+
+#define _log_once(log_macro, ...) { \
+    static std::atomic<bool> __st_log_done = false; \
+    if (!__st_log_done.load(std::memory_order_relaxed) && !__st_log_done.exchange(true, std::memory_order_relaxed)) log_macro(__VA_ARGS__) \
+}
+
+#define _log_every_ms(log_macro, ms, ...) { \
+    static std::atomic<s64> __st_log_next = 0; \
+    const s64 __st_log_now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); \
+    s64 __st_log_expected = __st_log_next.load(std::memory_order_relaxed); \
+    if (__st_log_now >= __st_log_expected && __st_log_next.compare_exchange_strong(__st_log_expected, __st_log_now + (s64)(ms), std::memory_order_relaxed)) log_macro(__VA_ARGS__) \
+}
+
 #ifndef _CONFIG_RELEASE
 
     #define log_trace(...)		{ SPDLOG_LOGGER_CALL(_get_spdlogger(), spdlog::level::trace, __VA_ARGS__); }
@@ -19,6 +143,42 @@ std::shared_ptr<spdlog::logger> ST_API _get_spdlogger();
 	#define log_error(...)		{ SPDLOG_LOGGER_CALL(_get_spdlogger(), spdlog::level::err, __VA_ARGS__); }
 	#define log_critical(...)	{ SPDLOG_LOGGER_CALL(_get_spdlogger(), spdlog::level::critical, __VA_ARGS__); }
 
+	// log_info_kv("Frame", {"fps", fps}, {"draw_calls", draw_calls});
+	#define log_trace_kv(msg, ...)		_log_kv(spdlog::level::trace, msg, __VA_ARGS__)
+	#define log_debug_kv(msg, ...)		_log_kv(spdlog::level::debug, msg, __VA_ARGS__)
+	#define log_info_kv(msg, ...)		_log_kv(spdlog::level::info, msg, __VA_ARGS__)
+	#define log_warn_kv(msg, ...)		_log_kv(spdlog::level::warn, msg, __VA_ARGS__)
+	#define log_error_kv(msg, ...)		_log_kv(spdlog::level::err, msg, __VA_ARGS__)
+	#define log_critical_kv(msg, ...)	_log_kv(spdlog::level::critical, msg, __VA_ARGS__)
+	#define log_trace_ch(channel, ...)		log_channel(channel, spdlog::level::trace, __VA_ARGS__)
+	#define log_debug_ch(channel, ...)		log_channel(channel, spdlog::level::debug, __VA_ARGS__)
+	#define log_info_ch(channel, ...)		log_channel(channel, spdlog::level::info, __VA_ARGS__)
+	#define log_warn_ch(channel, ...)		log_channel(channel, spdlog::level::warn, __VA_ARGS__)
+	#define log_error_ch(channel, ...)		log_channel(channel, spdlog::level::err, __VA_ARGS__)
+	#define log_critical_ch(channel, ...)	log_channel(channel, spdlog::level::critical, __VA_ARGS__)
+
+	// log_warn_every_n(100, ...), log_warn_once(...), log_warn_every_ms(1000, ...)
+	#define log_trace_every_n(n, ...)      _log_every_n(log_trace, n, __VA_ARGS__)
+	#define log_debug_every_n(n, ...)      _log_every_n(log_debug, n, __VA_ARGS__)
+	#define log_info_every_n(n, ...)       _log_every_n(log_info, n, __VA_ARGS__)
+	#define log_warn_every_n(n, ...)       _log_every_n(log_warn, n, __VA_ARGS__)
+	#define log_error_every_n(n, ...)      _log_every_n(log_error, n, __VA_ARGS__)
+	#define log_critical_every_n(n, ...)   _log_every_n(log_critical, n, __VA_ARGS__)
+
+	#define log_trace_once(...)            _log_once(log_trace, __VA_ARGS__)
+	#define log_debug_once(...)            _log_once(log_debug, __VA_ARGS__)
+	#define log_info_once(...)             _log_once(log_info, __VA_ARGS__)
+	#define log_warn_once(...)             _log_once(log_warn, __VA_ARGS__)
+	#define log_error_once(...)            _log_once(log_error, __VA_ARGS__)
+	#define log_critical_once(...)         _log_once(log_critical, __VA_ARGS__)
+
+	#define log_trace_every_ms(ms, ...)    _log_every_ms(log_trace, ms, __VA_ARGS__)
+	#define log_debug_every_ms(ms, ...)    _log_every_ms(log_debug, ms, __VA_ARGS__)
+	#define log_info_every_ms(ms, ...)     _log_every_ms(log_info, ms, __VA_ARGS__)
+	#define log_warn_every_ms(ms, ...)     _log_every_ms(log_warn, ms, __VA_ARGS__)
+	#define log_error_every_ms(ms, ...)    _log_every_ms(log_error, ms, __VA_ARGS__)
+	#define log_critical_every_ms(ms, ...) _log_every_ms(log_critical, ms, __VA_ARGS__)
+
 #else
     #define log_trace(...) (void)0
 	#define log_debug(...) (void)0
@@ -26,4 +186,39 @@ std::shared_ptr<spdlog::logger> ST_API _get_spdlogger();
 	#define log_warn(...) (void)0
 	#define log_error(...) (void)0
 	#define log_critical(...)	{ SPDLOG_LOGGER_CALL(_get_spdlogger(), spdlog::level::critical, __VA_ARGS__); }
+
+	#define log_trace_kv(msg, ...) (void)0
+	#define log_debug_kv(msg, ...) (void)0
+	#define log_info_kv(msg, ...) (void)0
+	#define log_warn_kv(msg, ...) (void)0
+	#define log_error_kv(msg, ...) (void)0
+	#define log_critical_kv(msg, ...)	_log_kv(spdlog::level::critical, msg, __VA_ARGS__)
+
+	#define log_trace_ch(channel, ...) (void)0
+	#define log_debug_ch(channel, ...) (void)0
+	#define log_info_ch(channel, ...) (void)0
+	#define log_warn_ch(channel, ...) (void)0
+	#define log_error_ch(channel, ...) (void)0
+	#define log_critical_ch(channel, ...)	log_channel(channel, spdlog::level::critical, __VA_ARGS__)
+
+	#define log_trace_every_n(n, ...)      (void)0
+	#define log_debug_every_n(n, ...)      (void)0
+	#define log_info_every_n(n, ...)       (void)0
+	#define log_warn_every_n(n, ...)       (void)0
+	#define log_error_every_n(n, ...)      (void)0
+	#define log_critical_every_n(n, ...)   _log_every_n(log_critical, n, __VA_ARGS__)
+
+	#define log_trace_once(...)            (void)0
+	#define log_debug_once(...)            (void)0
+	#define log_info_once(...)             (void)0
+	#define log_warn_once(...)             (void)0
+	#define log_error_once(...)            (void)0
+	#define log_critical_once(...)         _log_once(log_critical, __VA_ARGS__)
+
+	#define log_trace_every_ms(ms, ...)    (void)0
+	#define log_debug_every_ms(ms, ...)    (void)0
+	#define log_info_every_ms(ms, ...)     (void)0
+	#define log_warn_every_ms(ms, ...)     (void)0
+	#define log_error_every_ms(ms, ...)    (void)0
+	#define log_critical_every_ms(ms, ...) _log_every_ms(log_critical, ms, __VA_ARGS__)
 #endif
\ No newline at end of file
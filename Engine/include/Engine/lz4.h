@@ -0,0 +1,15 @@
+#pragma once
+
+// LZ4 block format (no frame header), compatible with the reference implementation's
+// LZ4_compress_default / LZ4_decompress_safe. Fast greedy compressor, decompression is
+// bounds checked and safe on untrusted input.
+
+constexpr size_t lz4_compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// Returns the compressed size, 0 if it doesn't fit in dst_capacity
+size_t ST_API lz4_compress(const byte_t* src, size_t src_size, byte_t* dst, size_t dst_capacity);
+
+// Returns the decompressed size, -1 on malformed input or if it doesn't fit in dst_capacity
+s64 ST_API lz4_decompress(const byte_t* src, size_t src_size, byte_t* dst, size_t dst_capacity);
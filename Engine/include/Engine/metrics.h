@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <initializer_list>
+
+// Named counters, gauges and histograms. Metrics live for the whole process, so the pointers
+// returned by get_* can be cached (the st_* macros cache them in a static at the call site).
+
+#define METRIC_COUNTER_SHARDS 16
+#define METRIC_MAX_BUCKETS 16
+#define MAX_METRICS 256
+
+// Threads are spread over the shards so frequently bumped counters don't share a cache line
+_st_force_inline u32 _metric_thread_shard() {
+    static std::atomic<u32> next_shard = 0;
+    thread_local u32 shard = next_shard.fetch_add(1, std::memory_order_relaxed) % METRIC_COUNTER_SHARDS;
+    return shard;
+}
+
+struct Metric_Counter {
+    struct alignas(64) Shard {
+        std::atomic<u64> value;
+    };
+
+    name_str_t name;
+    Shard shards[METRIC_COUNTER_SHARDS];
+
+    _st_force_inline void add(u64 n = 1) {
+        shards[_metric_thread_shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    u64 value() const {
+        u64 total = 0;
+        for (const auto& shard : shards) total += shard.value.load(std::memory_order_relaxed);
+        return total;
+    }
+};
+
+struct Metric_Gauge {
+    name_str_t name;
+    std::atomic<f64> value;
+
+    _st_force_inline void set(f64 v) { value.store(v, std::memory_order_relaxed); }
+    _st_force_inline void add(f64 v) { value.fetch_add(v, std::memory_order_relaxed); }
+};
+
+struct Metric_Histogram {
+    name_str_t name;
+
+    // Upper bounds of the buckets, values above the last one land in the overflow bucket
+    u32 bucket_count;
+    f64 bounds[METRIC_MAX_BUCKETS];
+
+    alignas(64) std::atomic<u64> buckets[METRIC_MAX_BUCKETS + 1];
+    std::atomic<u64> count;
+    std::atomic<f64> sum;
+
+    void record(f64 v) {
+        u32 bucket = 0;
+        while (bucket < bucket_count && v > bounds[bucket]) bucket++;
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(v, std::memory_order_relaxed);
+    }
+};
+
+// Returns the existing metric if the name is already registered. NULL once MAX_METRICS is reached.
+Metric_Counter* ST_API get_counter(str_ptr_t name);
+Metric_Gauge* ST_API get_gauge(str_ptr_t name);
+
+// Empty bounds use 1-2-5 steps from 0.1 to 10000
+Metric_Histogram* ST_API get_histogram(str_ptr_t name, std::initializer_list<f64> bounds = {});
+
+// Writes a snapshot of every metric as one JSON line to path every snapshot_interval frames
+bool ST_API init_metrics(str_ptr_t path, u32 snapshot_interval);
+void ST_API shutdown_metrics();
+
+void ST_API metrics_frame_end();
+void ST_API write_metrics_snapshot();
+
+#define _st_metric_concat_impl(a, b) a##b
+#define _st_metric_concat(a, b) _st_metric_concat_impl(a, b)
+
+#define st_counter_add(name, n) { static Metric_Counter* _st_metric_concat(__st_counter_, __LINE__) = get_counter(name); if (_st_metric_concat(__st_counter_, __LINE__)) _st_metric_concat(__st_counter_, __LINE__)->add(n); }
+#define st_gauge_set(name, v) { static Metric_Gauge* _st_metric_concat(__st_gauge_, __LINE__) = get_gauge(name); if (_st_metric_concat(__st_gauge_, __LINE__)) _st_metric_concat(__st_gauge_, __LINE__)->set(v); }
+#define st_gauge_add(name, v) { static Metric_Gauge* _st_metric_concat(__st_gauge_, __LINE__) = get_gauge(name); if (_st_metric_concat(__st_gauge_, __LINE__)) _st_metric_concat(__st_gauge_, __LINE__)->add(v); }
+#define st_histogram_record(name, v) { static Metric_Histogram* _st_metric_concat(__st_histogram_, __LINE__) = get_histogram(name); if (_st_metric_concat(__st_histogram_, __LINE__)) _st_metric_concat(__st_histogram_, __LINE__)->record(v); }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "os/io.h"
+
+// Pack archives: a header, the file data, then an index sorted by path hash and the
+// null-terminated paths the index refers to. Paths are relative, '/' separated.
+// Entries start on PACK_ALIGNMENT boundaries so they can be mapped or read with direct I/O
+// without straddling pages. The packer is the Packer project.
+
+#define PACK_MAGIC 0x4B505453 // "STPK"
+#define PACK_VERSION 2
+#define PACK_ALIGNMENT 4096
+
+enum Pack_Entry_Flags : u32 {
+    PACK_ENTRY_FLAG_NONE = 0,
+    PACK_ENTRY_FLAG_LZ4  = 1 << 0, // Stored as an LZ4 block (lz4.h)
+};
+
+struct Pack_Header {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 alignment;
+    u64 index_offset;
+    u64 names_offset;
+    u64 names_size;
+};
+
+struct Pack_Entry {
+    u64 path_hash; // fnv1a_64 of the path
+    u64 offset;
+    u64 stored_size;
+    u64 size;
+    u32 name_offset;
+    u32 name_length;
+    u32 flags;
+    u32 reserved;
+};
+
+// Read-only view of a mapped pack. Entry data points straight into the mapping.
+struct ST_API Pack_Archive {
+
+    Pack_Archive(str_ptr_t path);
+
+    const Pack_Entry* find(str_ptr_t path) const;
+    const Pack_Entry* find(str_ptr_t path, u64 path_hash) const;
+
+    str_ptr_t get_name(const Pack_Entry& entry) const;
+
+    // Stored bytes, compressed unless flags say otherwise
+    const byte_t* get_data(const Pack_Entry& entry) const;
+
+    // Copies or decompresses the entry into dst, which must hold entry.size bytes
+    bool read(const Pack_Entry& entry, byte_t* dst) const;
+
+    const Pack_Entry* entries = NULL;
+    u32 entry_count = 0;
+
+    os::io::Mapped_File file;
+
+    os::io::Io_Status _status = os::io::IO_STATUS_UNSET;
+};
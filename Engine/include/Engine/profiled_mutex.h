@@ -0,0 +1,84 @@
+#pragma once
+
+#include "profiler.h"
+
+#include <mutex>
+
+// Contention statistics, shared by every Profiled_Mutex registered under the same name
+struct Lock_Stats {
+    name_str_t name;
+
+    // Zone name used for time spent waiting on the lock, e.g. "Lock wait: log console"
+    str256_t wait_zone;
+
+    std::atomic<u64> acquisitions;
+    std::atomic<u64> contentions;
+    std::atomic<u64> wait_ns;
+    std::atomic<u64> max_wait_ns;
+    std::atomic<u64> hold_ns;
+    std::atomic<u64> max_hold_ns;
+};
+
+#define MAX_PROFILED_LOCKS 256
+
+Lock_Stats* ST_API register_lock_stats(str_ptr_t name);
+
+// Returns the number of registered locks, stats points at the first one
+u32 ST_API get_lock_stats(Lock_Stats** stats);
+
+void ST_API reset_lock_stats();
+void ST_API log_lock_stats();
+
+_st_force_inline void _update_max(std::atomic<u64>& max, u64 value) {
+    u64 current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+// Drop-in for std::mutex (works with std::lock_guard/std::unique_lock) which records wait time,
+// hold time and contention counts. Time spent waiting shows up as a profiler zone.
+class Profiled_Mutex {
+public:
+    Profiled_Mutex(str_ptr_t name) : _stats(register_lock_stats(name)) {}
+
+    Profiled_Mutex(const Profiled_Mutex&) = delete;
+    Profiled_Mutex& operator=(const Profiled_Mutex&) = delete;
+
+    void lock() {
+        if (!_mutex.try_lock()) {
+            const u64 wait_begin = profiler_now_ns();
+            {
+                Profile_Scope zone(_stats->wait_zone);
+                _mutex.lock();
+            }
+            const u64 waited = profiler_now_ns() - wait_begin;
+
+            _stats->contentions.fetch_add(1, std::memory_order_relaxed);
+            _stats->wait_ns.fetch_add(waited, std::memory_order_relaxed);
+            _update_max(_stats->max_wait_ns, waited);
+        }
+        on_acquired();
+    }
+
+    bool try_lock() {
+        if (!_mutex.try_lock()) return false;
+        on_acquired();
+        return true;
+    }
+
+    void unlock() {
+        const u64 held = profiler_now_ns() - _locked_at;
+        _stats->hold_ns.fetch_add(held, std::memory_order_relaxed);
+        _update_max(_stats->max_hold_ns, held);
+        _mutex.unlock();
+    }
+
+    Lock_Stats* _stats;
+    u64 _locked_at = 0;
+    std::mutex _mutex;
+
+private:
+    void on_acquired() {
+        _locked_at = profiler_now_ns();
+        _stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+};
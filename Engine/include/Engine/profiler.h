@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+
+#include "os/perf_counters.h"
+
+// Instrumentation profiler. Zones are recorded into per-thread buffers which only their own thread
+// writes to, and exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+
+struct Profile_Zone_Event {
+    str_ptr_t name;
+    u64 begin_ns;
+    u64 end_ns;
+    u32 depth;
+
+    // Deltas over the zone, zero unless hardware counters are enabled
+    os::Perf_Counter_Values counters;
+};
+
+extern ST_API std::atomic<bool> _profiler_recording;
+
+u64 ST_API profiler_now_ns();
+
+void ST_API _profiler_zone_begin(str_ptr_t name);
+void ST_API _profiler_zone_end();
+
+struct Profile_Scope {
+    bool active;
+
+    _st_force_inline Profile_Scope(str_ptr_t name) : active(_profiler_recording.load(std::memory_order_relaxed)) {
+        if (active) _profiler_zone_begin(name);
+    }
+    _st_force_inline ~Profile_Scope() {
+        if (active) _profiler_zone_end();
+    }
+};
+
+// Name shown for the calling thread in exported traces
+void ST_API profiler_set_thread_name(str_ptr_t name);
+
+// Samples hardware counters (os/perf_counters.h) around every zone so traces and the overlay can
+// report IPC, cache misses and branch mispredicts per zone. Adds two counter reads per zone.
+// Returns false if counters can't be opened on the calling thread.
+bool ST_API profiler_enable_hw_counters(bool enabled);
+bool ST_API profiler_hw_counters_enabled();
+
+void ST_API profiler_begin_session();
+
+// Stops recording and writes everything recorded since profiler_begin_session to trace_path
+bool ST_API profiler_end_session(str_ptr_t trace_path);
+
+// Frames
+
+struct Profile_Frame_Node {
+    str_ptr_t name;
+    u64 total_ns;
+    u32 calls;
+    u32 depth;
+
+    os::Perf_Counter_Values counters;
+
+    s32 parent;
+    s32 first_child;
+    s32 next_sibling;
+};
+
+// Zones recorded on the frame thread during one frame, merged by call path
+struct Profile_Frame {
+    u64 index;
+    u64 begin_ns;
+    u64 end_ns;
+
+    // Roots are linked through next_sibling starting at nodes[0]
+    std::vector<Profile_Frame_Node> nodes;
+};
+
+struct Profile_Frame_Stat {
+    u64 index;
+    u64 begin_ns;
+    u64 duration_ns;
+
+    // Most expensive top level zone of the frame
+    str_ptr_t top_zone;
+    u64 top_zone_ns;
+};
+
+#define PROFILER_FRAME_HISTORY 4096
+
+struct Profile_Frame_History {
+    Profile_Frame_Stat frames[PROFILER_FRAME_HISTORY];
+    u64 count; // Total frames marked, frames[i % PROFILER_FRAME_HISTORY]
+};
+
+// Records zones on the frame thread even when no session is active, for the overlay
+void ST_API profiler_set_frame_capture(bool enabled);
+
+// Marks the end of a frame. Must always be called from the same thread. The frame's zones are
+// built into the back frame which is then swapped with the front one, so readers of
+// profiler_last_frame never touch what is being recorded.
+void ST_API profiler_frame_mark();
+
+// The last completed frame, only valid on the frame thread until the next profiler_frame_mark
+const Profile_Frame* ST_API profiler_last_frame();
+const Profile_Frame_History& ST_API profiler_frame_history();
+
+// Profiler overlay window: frame time graph, hierarchical zones of the last frame and the worst
+// frames of the last few seconds. Call on the frame thread.
+void ST_API profiler_do_gui(bool* open = NULL);
+
+#define _st_profile_concat_impl(a, b) a##b
+#define _st_profile_concat(a, b) _st_profile_concat_impl(a, b)
+
+#ifndef _ST_DISABLE_PROFILER
+
+    #define st_profile_scope() Profile_Scope _st_profile_concat(__st_profile_scope_, __LINE__)(_ST_FUNC_SIG)
+    #define st_profile_scope_named(name) Profile_Scope _st_profile_concat(__st_profile_scope_, __LINE__)(name)
+
+#else
+
+    #define st_profile_scope()
+    #define st_profile_scope_named(name)
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+// Startup phase timing. Phases are recorded on the main thread only, can nest, and are also
+// emitted as profiler zones so they show up in a trace if a session is already running.
+
+#define MAX_STARTUP_PHASES 64
+
+struct Startup_Phase {
+    str_ptr_t name;
+    u64 begin_ns;
+    u64 end_ns;
+    u32 depth;
+};
+
+void ST_API startup_phase_begin(str_ptr_t name);
+void ST_API startup_phase_end();
+
+// Logs the phase breakdown and total startup time, measured from the Engine's static
+// initialization. Also writes it as JSON if report_path is set.
+void ST_API startup_report(str_ptr_t report_path = NULL);
+
+u32 ST_API get_startup_phases(const Startup_Phase** phases);
+
+struct Startup_Scope {
+    _st_force_inline Startup_Scope(str_ptr_t name) { startup_phase_begin(name); }
+    _st_force_inline ~Startup_Scope() { startup_phase_end(); }
+};
+
+#define _st_startup_concat_impl(a, b) a##b
+#define _st_startup_concat(a, b) _st_startup_concat_impl(a, b)
+
+#define st_startup_scope(name) Startup_Scope _st_startup_concat(__startup_scope_, __LINE__)(name)
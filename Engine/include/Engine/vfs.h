@@ -0,0 +1,46 @@
+#pragma once
+
+#include "os/io.h"
+
+// Virtual file system. Directories and pack archives are mounted under virtual roots and their
+// files indexed once at mount time, so lookups are a single hash probe with no file system calls.
+// Virtual paths are '/' separated and relative ("textures/ui/button.png"), later mounts shadow
+// files of earlier ones.
+
+// 0 is never a valid mount
+typedef u32 vfs_mount_t;
+
+// Read-only view of a file. Uncompressed files inside packs point into the archive's mapping, the
+// pack has to stay mounted while they are open. Compressed ones are decompressed into __buffer.
+struct ST_API Vfs_File {
+
+    Vfs_File() = default;
+    Vfs_File(Vfs_File&& other);
+    Vfs_File& operator=(Vfs_File&& other);
+    ~Vfs_File();
+
+    Vfs_File(const Vfs_File&) = delete;
+    Vfs_File& operator=(const Vfs_File&) = delete;
+
+    const byte_t* data = NULL;
+    size_t size = 0;
+
+    os::io::Io_Status _status = os::io::IO_STATUS_UNSET;
+
+    // Loose files are mapped individually
+    os::io::Mapped_File* __mapping = NULL;
+    byte_t* __buffer = NULL;
+};
+
+// real_path is either a directory or a pack archive, virtual_root may be empty
+vfs_mount_t ST_API vfs_mount(str_ptr_t virtual_root, str_ptr_t real_path);
+bool ST_API vfs_unmount(vfs_mount_t mount);
+void ST_API vfs_unmount_all();
+
+bool ST_API vfs_exists(str_ptr_t path);
+Vfs_File ST_API vfs_open(str_ptr_t path);
+
+// Real path of a loose file, false if the file doesn't exist or lives in a pack
+bool ST_API vfs_resolve(str_ptr_t path, path_str_t real_path);
+
+u32 ST_API vfs_file_count();
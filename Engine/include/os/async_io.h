@@ -0,0 +1,100 @@
+#pragma once
+
+// os API
+
+#include "os/io.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+// 0 is never a valid request
+typedef u64 async_request_t;
+
+struct Async_Result {
+    async_request_t id;
+    Io_Status status;
+
+    // Bytes transferred, short reads mean end of file
+    s64 bytes;
+
+    void* buffer;
+    void* user_data;
+};
+
+typedef void (*async_callback_t)(const Async_Result& result);
+
+enum Async_Op : u8 {
+    ASYNC_OP_READ,
+    ASYNC_OP_WRITE,
+};
+
+struct Async_Request {
+    async_request_t id;
+    Async_Op op;
+    const File* file;
+    void* buffer;
+    size_t size;
+    u64 offset;
+    async_callback_t callback;
+    void* user_data;
+
+    // Transferred so far, a short kernel completion is pushed again for the rest
+    s64 bytes;
+    Io_Status status;
+    u8 state;
+};
+
+// Kernel completion queue, io_uring on Linux. Create returns NULL when it's unavailable and
+// Async_Io falls back to its thread pool.
+struct _Async_Kernel_Queue;
+// Largest single transfer the kernel does, matches Linux MAX_RW_COUNT
+#define _ASYNC_KERNEL_MAX_TRANSFER 0x7ffff000
+_Async_Kernel_Queue* _async_kernel_queue_create(u32 queue_depth);
+void _async_kernel_queue_destroy(_Async_Kernel_Queue* queue);
+// Pushes the part of the request past request->bytes, at most _ASYNC_KERNEL_MAX_TRANSFER
+bool _async_kernel_queue_push(_Async_Kernel_Queue* queue, Async_Request* request);
+bool _async_kernel_queue_push_cancel(_Async_Kernel_Queue* queue, Async_Request* request);
+u32 _async_kernel_queue_submit(_Async_Kernel_Queue* queue);
+// Calls complete for every finished request, blocks for at least one if wait is set
+u32 _async_kernel_queue_reap(_Async_Kernel_Queue* queue, bool wait, void (*complete)(Async_Request* request, s64 bytes, Io_Status status, void* context), void* context);
+
+// Asynchronous reads and writes with batched submission. Requests are queued by read/write,
+// handed to the backend together by submit, and their callbacks run on the thread calling poll.
+// An Async_Io belongs to the thread that created it, buffers must outlive their requests.
+struct ST_API Async_Io {
+
+    Async_Io(u32 queue_depth = 256, u32 fallback_threads = 4);
+    ~Async_Io();
+
+    Async_Io(const Async_Io&) = delete;
+    Async_Io& operator=(const Async_Io&) = delete;
+
+    // Return 0 when all queue_depth requests are in use, poll to free some
+    async_request_t read(const File& file, void* buffer, size_t size, u64 offset, async_callback_t callback, void* user_data = NULL);
+    async_request_t write(const File& file, const void* buffer, size_t size, u64 offset, async_callback_t callback, void* user_data = NULL);
+
+    // Returns the number of requests handed to the backend
+    u32 submit();
+
+    // Runs the callbacks of completed requests. With wait set, blocks until at least one
+    // completes if any are in flight. Returns the number of callbacks run.
+    u32 poll(bool wait = false);
+
+    // Waits for every request in flight
+    void drain();
+
+    // The callback still runs, with IO_STATUS_CANCELLED if the request was stopped in time.
+    // Requests a worker or the kernel already started may still complete normally.
+    // False if the request is unknown, already done or being executed by a worker.
+    bool cancel(async_request_t id);
+
+    u32 get_in_flight() const;
+    bool is_kernel_backed() const;
+
+    Io_Status _status = IO_STATUS_UNSET;
+
+    struct Async_Io_State* __state = NULL;
+};
+
+NS_END(io)
+NS_END(os)
@@ -0,0 +1,41 @@
+#pragma once
+
+// os API
+
+#include "os/io.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+// Replaces a file so that a crash or a concurrent reader only ever sees the old or the complete
+// new contents. Data goes to a temporary file next to the destination which commit syncs and
+// renames over it. Small writes are gathered into batch_size bytes before they reach the file.
+// Destroying the writer without committing throws the new contents away.
+struct ST_API Atomic_File_Writer {
+
+    // expected_size preallocates the temporary file, 0 if unknown
+    Atomic_File_Writer(str_ptr_t path, u64 expected_size = 0, size_t batch_size = 64 * 1024);
+    ~Atomic_File_Writer();
+
+    Atomic_File_Writer(const Atomic_File_Writer&) = delete;
+    Atomic_File_Writer& operator=(const Atomic_File_Writer&) = delete;
+
+    // False once anything has failed, the error is left in _status and commit fails too
+    bool write(const void* data, size_t size);
+
+    // The destination is only touched here. The writer can't be used afterwards.
+    Io_Status commit();
+
+    // Bytes written so far, including those still batched
+    u64 get_written() const;
+
+    Io_Status _status = IO_STATUS_UNSET;
+
+    struct Atomic_File_Writer_State* __state = NULL;
+};
+
+// The whole file in one go
+Io_Status ST_API write_file_atomic(str_ptr_t path, const void* data, size_t size);
+
+NS_END(io)
+NS_END(os)
@@ -0,0 +1,11 @@
+#pragma once
+
+// os API
+
+NS_BEGIN(os)
+
+// Installs handlers for fatal signals/exceptions (including st_assert's _AP_BREAK) which dump
+// the log ring and a backtrace to stderr, and to crash_log_path if given, before terminating.
+void ST_API install_crash_handlers(str_ptr_t crash_log_path = NULL);
+
+NS_END(os)
@@ -0,0 +1,65 @@
+#pragma once
+
+// os API
+
+#include "os/io.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+enum Dir_Entry_Type : u8 {
+    DIR_ENTRY_FILE,
+    DIR_ENTRY_DIRECTORY,
+    DIR_ENTRY_SYMLINK,
+    DIR_ENTRY_OTHER,
+};
+
+struct Dir_Entry {
+    // Relative to the scanned root, '/' separated and null-terminated
+    str_ptr_t path;
+    u32 path_length;
+    Dir_Entry_Type type;
+
+    // Only filled with DIR_SCAN_STAT
+    u64 size;
+    u64 modified_ns;
+};
+
+enum Dir_Scan_Flags : u32 {
+    DIR_SCAN_NONE       = 0,
+    DIR_SCAN_RECURSIVE  = 1 << 0, // Symlinked directories are reported but not followed
+    DIR_SCAN_STAT       = 1 << 1, // Fill size and modified_ns, costs a stat per entry on Linux
+    DIR_SCAN_FILES_ONLY = 1 << 2, // Directories are still descended into, just not reported
+};
+
+// Raw directory reads (getdents64 on Linux, FindFirstFileEx on Windows)
+typedef void (*_dir_emit_fn_t)(void* context, str_ptr_t name, size_t name_length, Dir_Entry_Type type, u64 size, u64 modified_ns);
+void* _dir_scan_open_root(str_ptr_t root);
+void _dir_scan_close_root(void* root);
+// relative is "" for the root itself
+bool _dir_scan_read(void* root, str_ptr_t root_path, str_ptr_t relative, u32 flags, _dir_emit_fn_t emit, void* context);
+
+// Scans a directory into one block of entries. Paths live in arenas owned by the scan, nothing
+// is allocated per entry. With threads > 1 subdirectories are scanned in parallel and the order
+// of entries is unspecified, otherwise parents come before their children.
+struct ST_API Dir_Scan {
+
+    Dir_Scan(str_ptr_t root, u32 flags = DIR_SCAN_RECURSIVE, u32 threads = 1);
+    ~Dir_Scan();
+
+    Dir_Scan(const Dir_Scan&) = delete;
+    Dir_Scan& operator=(const Dir_Scan&) = delete;
+
+    const Dir_Entry* entries = NULL;
+    u32 entry_count = 0;
+
+    // Directories that couldn't be opened, their entries are missing
+    u32 error_count = 0;
+
+    Io_Status _status = IO_STATUS_UNSET;
+
+    struct Dir_Scan_State* __state = NULL;
+};
+
+NS_END(io)
+NS_END(os)
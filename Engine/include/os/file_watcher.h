@@ -0,0 +1,63 @@
+#pragma once
+
+// os API
+
+#include "os/io.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+enum File_Change_Flags : u32 {
+    FILE_CHANGE_MODIFIED = 1 << 0,
+    FILE_CHANGE_CREATED  = 1 << 1, // Also files moved into a watched directory
+    FILE_CHANGE_DELETED  = 1 << 2, // Also files moved out of a watched directory
+};
+
+struct File_Change_Event {
+    // Watched directory joined with the path below it, '/' separated
+    path_str_t path;
+
+    // Everything that happened to the file since the last dispatch
+    u32 changes;
+};
+
+typedef void (*file_change_fn_t)(const File_Change_Event& event, void* user_data);
+
+// Raw change notifications from the OS (inotify on Linux, ReadDirectoryChangesW on Windows)
+struct _File_Watch_Queue;
+_File_Watch_Queue* _file_watch_queue_create();
+void _file_watch_queue_destroy(_File_Watch_Queue* queue);
+bool _file_watch_queue_add(_File_Watch_Queue* queue, str_ptr_t directory, bool recursive);
+// Calls emit for every event available without blocking
+void _file_watch_queue_read(_File_Watch_Queue* queue, void (*emit)(str_ptr_t path, u32 changes, void* context), void* context);
+
+// Watches directories and dispatches coalesced changes to subscribers from poll, which is meant to
+// be called once per frame. Changes are held back until a file has been quiet for settle_ms so
+// bursts (editors writing a temp file and renaming it, exporters writing in chunks) arrive once.
+// A File_Watcher belongs to the thread that created it.
+struct ST_API File_Watcher {
+
+    File_Watcher();
+    ~File_Watcher();
+
+    File_Watcher(const File_Watcher&) = delete;
+    File_Watcher& operator=(const File_Watcher&) = delete;
+
+    bool watch(str_ptr_t directory, bool recursive = true);
+
+    // fn is called for changed files whose path starts with path_prefix. Returns 0 on failure.
+    u32 subscribe(str_ptr_t path_prefix, file_change_fn_t fn, void* user_data = NULL);
+    void unsubscribe(u32 subscription);
+
+    // Returns the number of changes dispatched
+    u32 poll();
+
+    u32 settle_ms = 100;
+
+    Io_Status _status = IO_STATUS_UNSET;
+
+    struct File_Watcher_State* __state = NULL;
+};
+
+NS_END(io)
+NS_END(os)
@@ -1,15 +1,167 @@
 #pragma once
 
+#include <string_view>
+
 NS_BEGIN(os)
 NS_BEGIN(io)
 
+enum ST_API Io_Status : s8 {
+    IO_STATUS_UNSET,
+    IO_STATUS_OK,
+    IO_STATUS_FILE_NOT_FOUND,
+    IO_STATUS_ACCESS_DENIED,
+    IO_STATUS_INVALID_ARGUMENT,
+    IO_STATUS_INVALID_FORMAT,
+    IO_STATUS_OUT_OF_MEMORY,
+    IO_STATUS_CANCELLED,
+    IO_STATUS_ALREADY_EXISTS,
+    IO_STATUS_UNKNOWN_ERROR,
+};
+inline str_ptr_t Io_Status_string(Io_Status value) {
+    switch (value) {
+        case IO_STATUS_OK:
+            return "OK";
+        case IO_STATUS_FILE_NOT_FOUND:
+            return "File Not Found";
+        case IO_STATUS_ACCESS_DENIED:
+            return "Access Denied";
+        case IO_STATUS_INVALID_ARGUMENT:
+            return "Invalid Argument";
+        case IO_STATUS_INVALID_FORMAT:
+            return "Invalid Format";
+        case IO_STATUS_OUT_OF_MEMORY:
+            return "Out Of Memory";
+        case IO_STATUS_CANCELLED:
+            return "Cancelled";
+        case IO_STATUS_ALREADY_EXISTS:
+            return "Already Exists";
+        case IO_STATUS_UNKNOWN_ERROR:
+            return "Unknown Error";
+        default:
+            return "Missing error string";
+    }
+}
+
+enum File_Access : u8 {
+    FILE_ACCESS_READ,
+    FILE_ACCESS_WRITE,
+    FILE_ACCESS_READ_WRITE,
+};
+
+enum File_Flags : u32 {
+    FILE_FLAG_NONE      = 0,
+    FILE_FLAG_CREATE    = 1 << 0, // Create the file if it doesn't exist
+    FILE_FLAG_TRUNCATE  = 1 << 1,
+    FILE_FLAG_EXCLUSIVE = 1 << 2, // With CREATE, fail with IO_STATUS_ALREADY_EXISTS instead of opening
+};
+
+// Unbuffered file with positional reads and writes, safe to use from several threads at once
+struct ST_API File {
+
+    File(str_ptr_t path, File_Access access = FILE_ACCESS_READ, u32 flags = FILE_FLAG_NONE);
+    ~File();
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    // Both loop until size bytes are transferred, end of file or an error.
+    // Return the number of bytes transferred, -1 on error.
+    s64 read_at(void* buffer, size_t size, u64 offset) const;
+    s64 write_at(const void* buffer, size_t size, u64 offset) const;
+
+    u64 get_size() const;
+
+    // Blocks until written data has reached the disk
+    bool sync() const;
+
+    // Reserves disk space without changing the size, cuts fragmentation of files written in
+    // pieces. False where the filesystem doesn't support it, which is harmless.
+    bool preallocate(u64 size) const;
+
+    File_Access access = FILE_ACCESS_READ;
+
+    Io_Status _status = IO_STATUS_UNSET;
+
+    void* __os_handle = 0;
+};
+
+enum Mapping_Access : u8 {
+    MAPPING_ACCESS_READ_ONLY,
+    // Writes go straight to the file, which keeps its size
+    MAPPING_ACCESS_READ_WRITE,
+};
+
+enum Mapping_Flags : u32 {
+    MAPPING_FLAG_NONE       = 0,
+    MAPPING_FLAG_SEQUENTIAL = 1 << 0, // Read ahead aggressively, drop pages behind
+    MAPPING_FLAG_RANDOM     = 1 << 1, // Disable read ahead
+    MAPPING_FLAG_PREFAULT   = 1 << 2, // Read the whole file in up front instead of faulting on access
+};
+
+// Maps a whole file into memory. Mapping an empty file succeeds with a NULL data pointer.
+struct ST_API Mapped_File {
+
+    Mapped_File(str_ptr_t path, Mapping_Access access = MAPPING_ACCESS_READ_ONLY, u32 flags = MAPPING_FLAG_NONE);
+    ~Mapped_File();
+
+    Mapped_File(const Mapped_File&) = delete;
+    Mapped_File& operator=(const Mapped_File&) = delete;
+
+    // Changes the access hint for a range, size 0 means until the end of the file
+    void advise(u32 flags, size_t offset = 0, size_t size = 0);
+
+    // Writes dirty pages of a read-write mapping back to the file
+    bool flush();
+
+    byte_t* data = NULL;
+    size_t size = 0;
+    Mapping_Access access = MAPPING_ACCESS_READ_ONLY;
+
+    Io_Status _status = IO_STATUS_UNSET;
+
+    void* __os_handle = 0;
+};
+
 New_String ST_API get_exe_path();
 
+// Atomically replaces to with from, durable once this returns true. Both must be on the same volume.
+bool ST_API replace_file(str_ptr_t from, str_ptr_t to);
+
+bool ST_API remove_file(str_ptr_t path);
+
 // NOT OS SPECIFIC
 
 New_String ST_API get_directory(str_ptr_t path); 
 
 New_String ST_API get_exe_dir();
 
+// Computed on first use, call it during startup to keep it off hot paths
+str_ptr_t ST_API get_cached_exe_dir();
+
+// Path utilities. None of them allocate: results are views into the input or written to a
+// caller provided buffer, false means the result didn't fit. '/' and '\\' are both accepted
+// as separators, written paths use '/'.
+
+bool ST_API is_absolute_path(std::string_view path);
+
+// Everything before the last separator, "" if there is none
+std::string_view ST_API path_directory(std::string_view path);
+// Everything after the last separator
+std::string_view ST_API path_filename(std::string_view path);
+// Extension of the filename including the dot, "" if it has none
+std::string_view ST_API path_extension(std::string_view path);
+// Filename without its extension
+std::string_view ST_API path_stem(std::string_view path);
+
+// b is returned as is if it's absolute. The result isn't normalized.
+bool ST_API path_join(path_str_t out, std::string_view a, std::string_view b);
+
+// Drops empty and "." segments and resolves ".." where possible. out may alias path.
+bool ST_API path_normalize(path_str_t out, str_ptr_t path);
+
+// path relative to base ("../textures/a.png"), both are normalized first. False if their roots
+// differ (relative and absolute, other drives) or base starts with ".." segments path doesn't share.
+bool ST_API path_relative(path_str_t out, str_ptr_t path, str_ptr_t base);
+
 NS_END(io)
-NS_END(os)
\ No newline at end of file
+NS_END(os)
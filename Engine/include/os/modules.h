@@ -17,7 +17,7 @@ enum ST_API Module_Status : s8 {
     MODULE_STATUS_INVALID_DRIVE,
     MODULE_STATUS_UNKNOWN_ERROR,
 };
-str_ptr_t Module_Status_string(Module_Status value) {
+inline str_ptr_t Module_Status_string(Module_Status value) {
     switch (value) {
         case MODULE_STATUS_OK:
             return "OK";
@@ -0,0 +1,22 @@
+#pragma once
+
+// os API
+
+NS_BEGIN(os)
+
+struct Perf_Counter_Values {
+    u64 instructions;
+    u64 cycles;
+    u64 cache_misses;
+    u64 branch_misses;
+};
+
+// Opens user space hardware counters for the calling thread. Fails when the OS or the machine
+// doesn't expose them (e.g. perf_event_paranoid, VMs without a virtual PMU).
+bool ST_API open_thread_perf_counters();
+void ST_API close_thread_perf_counters();
+
+// Current totals for the calling thread, false if its counters aren't open
+bool ST_API read_thread_perf_counters(Perf_Counter_Values* values);
+
+NS_END(os)
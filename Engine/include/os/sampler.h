@@ -0,0 +1,26 @@
+#pragma once
+
+// os API
+
+NS_BEGIN(os)
+
+// Statistical sampler. Registered threads get a CPU time timer that interrupts them at the
+// sampling frequency; the handler walks the frame pointer chain into a preallocated buffer.
+// Symbolization only happens in sampler_write_folded, so modules must still be loaded then.
+// Needs frame pointers (-fno-omit-frame-pointer), only implemented on Linux.
+
+#define SAMPLER_MAX_DEPTH 64
+#define MAX_SAMPLER_THREADS 64
+
+bool ST_API sampler_register_thread(str_ptr_t name);
+void ST_API sampler_unregister_thread();
+
+// max_samples are allocated up front, samples past that are dropped
+bool ST_API sampler_start(u32 frequency_hz = 997, u32 max_samples = 1 << 16);
+void ST_API sampler_stop();
+
+// Writes the samples recorded by the last run as folded stacks ("thread;root;...;leaf count"),
+// the input format of flamegraph.pl, speedscope and friends
+bool ST_API sampler_write_folded(str_ptr_t path);
+
+NS_END(os)
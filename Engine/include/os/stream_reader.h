@@ -0,0 +1,48 @@
+#pragma once
+
+// os API
+
+#include "os/async_io.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+struct Stream_Chunk {
+    const byte_t* data;
+    size_t size;
+
+    // Position of data in the file
+    u64 offset;
+};
+
+// Reads a file front to back in chunk_size pieces. While one chunk is consumed the next is
+// already being read through Async_Io, so memory use is two chunks whatever the file size.
+// Pass an Async_Io to share it between streams, otherwise the reader makes its own. Either way
+// the reader belongs to the thread owning the Async_Io.
+struct ST_API Stream_Reader {
+
+    Stream_Reader(str_ptr_t path, size_t chunk_size = 1024 * 1024, Async_Io* io = NULL);
+    ~Stream_Reader();
+
+    Stream_Reader(const Stream_Reader&) = delete;
+    Stream_Reader& operator=(const Stream_Reader&) = delete;
+
+    // The chunk stays valid until the next call to next or seek. False at end of file or on an
+    // error, which is left in _status.
+    bool next(Stream_Chunk* chunk);
+
+    // Drops both buffers and restarts the prefetch at offset
+    bool seek(u64 offset);
+
+    u64 get_size() const;
+
+    // Times next had to wait for a read to finish, the consumer outran the disk
+    u32 get_stall_count() const;
+
+    Io_Status _status = IO_STATUS_UNSET;
+
+    struct Stream_Reader_State* __state = NULL;
+};
+
+NS_END(io)
+NS_END(os)
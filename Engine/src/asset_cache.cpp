@@ -0,0 +1,148 @@
+#include "pch.h"
+
+#include "asset_cache.h"
+#include "hash.h"
+#include "logger.h"
+#include "metrics.h"
+
+#include "os/atomic_writer.h"
+
+#include <filesystem>
+
+path_str_t asset_cache_directory = "";
+
+static_assert(sizeof(Asset_Cache_Header) <= ASSET_CACHE_DATA_OFFSET);
+
+// Entries are spread over 256 subdirectories by their first byte. False if the path doesn't fit.
+static bool get_entry_path(asset_key_t key, path_str_t out) {
+    const int length = snprintf(out, sizeof(path_str_t), "%s/%02x/%016llx", asset_cache_directory, (u32)(key >> 56), (unsigned long long)key);
+    return length >= 0 && (size_t)length < sizeof(path_str_t);
+}
+
+asset_key_t asset_cache_key(const void* source, size_t source_size, str_ptr_t importer, u32 importer_version, const void* settings, size_t settings_size) {
+    u64 hash = xxh64(source, source_size);
+    hash = xxh64(importer, strlen(importer), hash);
+    hash = xxh64(&importer_version, sizeof(importer_version), hash);
+    if (settings_size > 0) hash = xxh64(settings, settings_size, hash);
+    return hash;
+}
+
+bool init_asset_cache(str_ptr_t directory) {
+    // Room for "/xx/<16 hex digits>" after the directory
+    if (strlen(directory) + 20 >= sizeof(asset_cache_directory)) {
+        log_error("Asset cache path '{}' is too long", directory);
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        log_error("Could not create asset cache '{}': {}", directory, error.message());
+        return false;
+    }
+
+    strcpy(asset_cache_directory, directory);
+    log_info("Asset cache at '{}'", asset_cache_directory);
+    return true;
+}
+
+void shutdown_asset_cache() {
+    asset_cache_directory[0] = '\0';
+}
+
+bool asset_cache_enabled() {
+    return asset_cache_directory[0] != '\0';
+}
+
+Asset_Cache_Entry asset_cache_load(asset_key_t key) {
+    Asset_Cache_Entry entry;
+    if (!asset_cache_enabled()) {
+        entry._status = os::io::IO_STATUS_FILE_NOT_FOUND;
+        return entry;
+    }
+
+    path_str_t path;
+    if (!get_entry_path(key, path)) {
+        entry._status = os::io::IO_STATUS_FILE_NOT_FOUND;
+        st_counter_add("asset_cache.misses", 1);
+        return entry;
+    }
+
+    entry.__mapping = new os::io::Mapped_File(path, os::io::MAPPING_ACCESS_READ_ONLY, os::io::MAPPING_FLAG_SEQUENTIAL);
+    entry._status = entry.__mapping->_status;
+    if (entry._status != os::io::IO_STATUS_OK) {
+        st_counter_add("asset_cache.misses", 1);
+        return entry;
+    }
+
+    // Entries are only ever renamed into place whole, anything else is a foreign file or an old format
+    const auto& mapping = *entry.__mapping;
+    Asset_Cache_Header header;
+    if (mapping.size >= ASSET_CACHE_DATA_OFFSET) memcpy(&header, mapping.data, sizeof(header));
+    if (mapping.size < ASSET_CACHE_DATA_OFFSET || header.magic != ASSET_CACHE_MAGIC || header.version != ASSET_CACHE_VERSION
+        || header.key != key || header.size != mapping.size - ASSET_CACHE_DATA_OFFSET) {
+        log_warn("Ignoring invalid asset cache entry '{}'", path);
+        entry._status = os::io::IO_STATUS_INVALID_FORMAT;
+        st_counter_add("asset_cache.misses", 1);
+        return entry;
+    }
+
+    entry.data = mapping.data + ASSET_CACHE_DATA_OFFSET;
+    entry.size = header.size;
+    st_counter_add("asset_cache.hits", 1);
+    return entry;
+}
+
+bool asset_cache_store(asset_key_t key, const void* data, size_t size) {
+    if (!asset_cache_enabled()) return false;
+
+    path_str_t path;
+    if (!get_entry_path(key, path)) {
+        log_error("Could not write asset cache entry {:016x}, the cache path '{}' is too long", key, asset_cache_directory);
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(os::io::path_directory(path), error);
+
+    byte_t header[ASSET_CACHE_DATA_OFFSET] = {};
+    const Asset_Cache_Header info = { ASSET_CACHE_MAGIC, ASSET_CACHE_VERSION, key, size };
+    memcpy(header, &info, sizeof(info));
+
+    // Header and data go out as two writes, there is nothing to batch
+    os::io::Atomic_File_Writer writer(path, ASSET_CACHE_DATA_OFFSET + size, 0);
+    writer.write(header, sizeof(header));
+    writer.write(data, size);
+    const os::io::Io_Status status = writer.commit();
+    if (status != os::io::IO_STATUS_OK) {
+        log_error("Could not write asset cache entry '{}': {}", path, os::io::Io_Status_string(status));
+        return false;
+    }
+
+    st_counter_add("asset_cache.stored_bytes", size);
+    return true;
+}
+
+Asset_Cache_Entry::Asset_Cache_Entry(Asset_Cache_Entry&& other) {
+    *this = std::move(other);
+}
+
+Asset_Cache_Entry& Asset_Cache_Entry::operator=(Asset_Cache_Entry&& other) {
+    if (this == &other) return *this;
+    delete __mapping;
+
+    data = other.data;
+    size = other.size;
+    _status = other._status;
+    __mapping = other.__mapping;
+
+    other.data = NULL;
+    other.size = 0;
+    other._status = os::io::IO_STATUS_UNSET;
+    other.__mapping = NULL;
+    return *this;
+}
+
+Asset_Cache_Entry::~Asset_Cache_Entry() {
+    delete __mapping;
+}
@@ -0,0 +1,123 @@
+#include "pch.h"
+
+#include "image.h"
+#include "vfs.h"
+#include "logger.h"
+#include "profiler.h"
+
+#include "stb_image.h"
+
+// Bump when the decoded output changes, old cache entries then stop matching
+#define IMAGE_IMPORTER_VERSION 1
+
+// Prefix of a cached image, the pixels follow
+struct Image_Cache_Info {
+    u32 width;
+    u32 height;
+    u32 channels;
+    u32 reserved;
+};
+
+static void flip_rows(byte_t* pixels, size_t row_size, u32 height) {
+    std::vector<byte_t> row(row_size);
+    for (u32 top = 0, bottom = height - 1; top < bottom; top++, bottom--) {
+        byte_t* a = pixels + top * row_size;
+        byte_t* b = pixels + bottom * row_size;
+        memcpy(row.data(), a, row_size);
+        memcpy(a, b, row_size);
+        memcpy(b, row.data(), row_size);
+    }
+}
+
+Image load_image(str_ptr_t path, const Image_Import_Settings& settings) {
+    st_profile_scope();
+    Image image;
+
+    if (settings.channels > 4) {
+        image._status = os::io::IO_STATUS_INVALID_ARGUMENT;
+        return image;
+    }
+
+    Vfs_File source = vfs_open(path);
+    if (source._status != os::io::IO_STATUS_OK) {
+        image._status = source._status;
+        return image;
+    }
+
+    const asset_key_t key = asset_cache_key(source.data, source.size, "image", IMAGE_IMPORTER_VERSION, &settings, sizeof(settings));
+
+    Asset_Cache_Entry cached = asset_cache_load(key);
+    if (cached._status == os::io::IO_STATUS_OK && cached.size >= sizeof(Image_Cache_Info)) {
+        Image_Cache_Info info;
+        memcpy(&info, cached.data, sizeof(info));
+        if (cached.size == sizeof(info) + (size_t)info.width * info.height * info.channels) {
+            image.width = info.width;
+            image.height = info.height;
+            image.channels = info.channels;
+            image.pixels = cached.data + sizeof(info);
+            image.__cached = std::move(cached);
+            image._status = os::io::IO_STATUS_OK;
+            return image;
+        }
+    }
+
+    int width, height, source_channels;
+    {
+        st_profile_scope_named("stbi_load_from_memory");
+        image.__decoded = stbi_load_from_memory(source.data, (int)source.size, &width, &height, &source_channels, (int)settings.channels);
+    }
+    if (!image.__decoded) {
+        log_error("Could not decode image '{}': {}", path, stbi_failure_reason());
+        image._status = os::io::IO_STATUS_INVALID_FORMAT;
+        return image;
+    }
+
+    image.width = (u32)width;
+    image.height = (u32)height;
+    image.channels = settings.channels ? settings.channels : (u32)source_channels;
+    image.pixels = image.__decoded;
+
+    const size_t pixels_size = (size_t)image.width * image.height * image.channels;
+    if (settings.flip_vertically) flip_rows(image.__decoded, (size_t)image.width * image.channels, image.height);
+
+    if (asset_cache_enabled()) {
+        // Staged in one block so the entry is a single write after the header
+        std::vector<byte_t> output(sizeof(Image_Cache_Info) + pixels_size);
+        const Image_Cache_Info info = { image.width, image.height, image.channels, 0 };
+        memcpy(output.data(), &info, sizeof(info));
+        memcpy(output.data() + sizeof(info), image.pixels, pixels_size);
+        asset_cache_store(key, output.data(), output.size());
+    }
+
+    image._status = os::io::IO_STATUS_OK;
+    return image;
+}
+
+Image::Image(Image&& other) {
+    *this = std::move(other);
+}
+
+Image& Image::operator=(Image&& other) {
+    if (this == &other) return *this;
+    stbi_image_free(__decoded);
+
+    pixels = other.pixels;
+    width = other.width;
+    height = other.height;
+    channels = other.channels;
+    _status = other._status;
+    __cached = std::move(other.__cached);
+    __decoded = other.__decoded;
+
+    other.pixels = NULL;
+    other.width = 0;
+    other.height = 0;
+    other.channels = 0;
+    other._status = os::io::IO_STATUS_UNSET;
+    other.__decoded = NULL;
+    return *this;
+}
+
+Image::~Image() {
+    stbi_image_free(__decoded);
+}
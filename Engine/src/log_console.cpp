@@ -0,0 +1,227 @@
+#include "pch.h"
+
+#include "log_console.h"
+#include "logger.h"
+
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/pattern_formatter.h>
+
+#include <imgui.h>
+
+class log_console_sink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    log_console_sink(Log_Console* console) : console(console) {
+        formatter_ = std::make_unique<spdlog::pattern_formatter>("[%H:%M:%S.%e] [%l] %v");
+    }
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        spdlog::memory_buf_t formatted;
+        formatter_->format(msg, formatted);
+
+        // Drop the trailing newline, each entry is its own row
+        size_t len = formatted.size();
+        while (len > 0 && (formatted[len - 1] == '\n' || formatted[len - 1] == '\r')) len--;
+
+        console->push(msg.level, formatted.data(), len);
+    }
+
+    void flush_() override {}
+
+    Log_Console* console;
+};
+
+Log_Console::Log_Console(size_t arena_size, size_t max_entries) 
+    : _arena_size(arena_size), _max_entries(max_entries) {
+
+    st_assert(arena_size > 0 && max_entries > 0, "Log console needs a non-empty arena");
+
+    _arena = static_cast<char*>(malloc(_arena_size));
+    _entries = static_cast<Log_Console_Entry*>(malloc(_max_entries * sizeof(Log_Console_Entry)));
+
+    _filter_colors = new ImVec4[spdlog::level::n_levels] {
+        ImVec4(.6f, .6f, .6f, 1.f), // trace
+        ImVec4(.3f, .8f, .9f, 1.f), // debug
+        ImVec4(.4f, 1.f, .4f, 1.f), // info
+        ImVec4(1.f, .9f, .3f, 1.f), // warn
+        ImVec4(1.f, .3f, .3f, 1.f), // error
+        ImVec4(1.f, .1f, .8f, 1.f), // critical
+        ImVec4(1.f, 1.f, 1.f, 1.f), // off
+    };
+
+    for (auto& flag : _filter_flags) flag = true;
+
+    _sink = std::make_shared<log_console_sink>(this);
+    add_log_sink(_sink);
+}
+
+Log_Console::~Log_Console() {
+    remove_log_sink(_sink);
+    
+    free(_arena);
+    free(_entries);
+    delete[] _filter_colors;
+}
+
+void Log_Console::push(spdlog::level::level_enum level, const char* text, size_t len) {
+    std::lock_guard<Profiled_Mutex> lock(_mutex);
+
+    if (len > _arena_size) len = _arena_size;
+
+    // Entries never straddle the end of the arena so they can be rendered straight from it
+    u64 offset = _write_pos;
+    if ((offset % _arena_size) + len > _arena_size) {
+        offset += _arena_size - (offset % _arena_size);
+    }
+    const u64 end = offset + len;
+
+    // Evict whatever the new text overwrites, and the oldest entry if the index is full
+    while (_first_seq < _next_seq) {
+        const auto& oldest = _entries[_first_seq % _max_entries];
+        if (oldest.offset + _arena_size >= end && _next_seq - _first_seq < _max_entries) break;
+        _first_seq++;
+    }
+
+    memcpy(_arena + (offset % _arena_size), text, len);
+    _entries[_next_seq % _max_entries] = { offset, (u32)len, level };
+    _next_seq++;
+    _write_pos = end;
+    _has_new = true;
+}
+
+void Log_Console::clear() {
+    std::lock_guard<Profiled_Mutex> lock(_mutex);
+    _first_seq = _next_seq;
+    _filtered.clear();
+    _filtered_until = _next_seq;
+}
+
+void Log_Console::set_filter(spdlog::level::level_enum level, bool show) {
+    std::lock_guard<Profiled_Mutex> lock(_mutex);
+    if (_filter_flags[level] != show) {
+        _filter_flags[level] = show;
+        _filter_dirty = true;
+    }
+}
+
+void Log_Console::do_gui(str_ptr_t title, bool* open) {
+    if (!ImGui::Begin(title, open, ImGuiWindowFlags_MenuBar)) {
+        ImGui::End();
+        return;
+    }
+
+    // ImGui runs without the lock held so logging threads never wait on the frame, and logging
+    // from inside ImGui can't deadlock. Only short copies in and out happen under it.
+    bool filter_flags[spdlog::level::n_levels];
+    bool filter_toggled[spdlog::level::n_levels] = {};
+    size_t entries;
+    {
+        std::lock_guard<Profiled_Mutex> lock(_mutex);
+        memcpy(filter_flags, _filter_flags, sizeof(filter_flags));
+        entries = entry_count();
+    }
+
+    bool clear_entries = false;
+    if (ImGui::BeginMenuBar()) {
+        if (ImGui::BeginMenu("Settings")) {
+            ImGui::Checkbox("Auto scroll", &auto_scroll);
+            ImGui::Text("%zu entries, %zu KiB arena", entries, _arena_size / 1024);
+
+            ImGui::Separator();
+            ImGui::Text("Colors");
+            for (s32 level = spdlog::level::trace; level <= spdlog::level::critical; level++) {
+                ImGui::ColorEdit4(spdlog::level::to_string_view((spdlog::level::level_enum)level).data(), &_filter_colors[level].x);
+            }
+
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("Filter")) {
+            for (s32 level = spdlog::level::trace; level <= spdlog::level::critical; level++) {
+                if (level % 3 != 0) ImGui::SameLine();
+                if (ImGui::Checkbox(spdlog::level::to_string_view((spdlog::level::level_enum)level).data(), &filter_flags[level])) {
+                    filter_toggled[level] = true;
+                }
+            }
+
+            ImGui::EndMenu();
+        }
+        if (ImGui::MenuItem("Clear")) clear_entries = true;
+        ImGui::EndMenuBar();
+    }
+
+    size_t filtered_count;
+    bool has_new;
+    {
+        std::lock_guard<Profiled_Mutex> lock(_mutex);
+
+        for (s32 level = 0; level < spdlog::level::n_levels; level++) {
+            if (!filter_toggled[level]) continue;
+            _filter_flags[level] = filter_flags[level];
+            _filter_dirty = true;
+        }
+        if (clear_entries) {
+            _first_seq = _next_seq;
+            _filter_dirty = true;
+        }
+
+        if (_filter_dirty) {
+            _filtered.clear();
+            _filtered_until = _first_seq;
+            _filter_dirty = false;
+        }
+
+        // Forget evicted entries and filter only what arrived since the last frame
+        while (!_filtered.empty() && _filtered.front() < _first_seq) {
+            _filtered.pop_front();
+        }
+        if (_filtered_until < _first_seq) _filtered_until = _first_seq;
+        for (; _filtered_until < _next_seq; _filtered_until++) {
+            if (_filter_flags[_entries[_filtered_until % _max_entries].level]) {
+                _filtered.push_back(_filtered_until);
+            }
+        }
+
+        filtered_count = _filtered.size();
+        has_new = _has_new;
+        _has_new = false;
+    }
+
+    ImGui::BeginChild("entries");
+
+    ImGuiListClipper clipper;
+    clipper.Begin((int)filtered_count);
+    while (clipper.Step()) {
+        // Copy the visible rows out, the arena may be overwritten as soon as the lock is released.
+        // Rows evicted or cleared since the count was taken stay empty.
+        _visible.clear();
+        _visible_text.clear();
+        {
+            std::lock_guard<Profiled_Mutex> lock(_mutex);
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                if ((size_t)i >= _filtered.size() || _filtered[i] < _first_seq) {
+                    _visible.push_back({ _visible_text.size(), 0, spdlog::level::off });
+                    continue;
+                }
+
+                const auto& entry = _entries[_filtered[i] % _max_entries];
+                const char* text = _arena + (entry.offset % _arena_size);
+                _visible.push_back({ _visible_text.size(), entry.len, entry.level });
+                _visible_text.insert(_visible_text.end(), text, text + entry.len);
+            }
+        }
+
+        for (const auto& row : _visible) {
+            const char* text = row.len > 0 ? _visible_text.data() + row.offset : "";
+            ImGui::PushStyleColor(ImGuiCol_Text, _filter_colors[row.level]);
+            ImGui::TextUnformatted(text, text + row.len);
+            ImGui::PopStyleColor();
+        }
+    }
+    clipper.End();
+
+    if (has_new && auto_scroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.f);
+    }
+
+    ImGui::EndChild();
+    ImGui::End();
+}
@@ -8,78 +8,173 @@
 #include <spdlog/fmt/ostr.h>
 
 #include "logger.h"
+#include "json.h"
+#include "profiled_mutex.h"
 
 #include <spdlog/sinks/base_sink.h>
+#include <spdlog/pattern_formatter.h>
 
+#include <atomic>
 
-/*template<typename Mutex>
-class imgui_sink : public spdlog::sinks::base_sink <Mutex>
-{
+#ifdef _ST_OS_WINDOWS
+    #include <io.h>
+    #define _st_write_fd _write
+#else
+    #include <unistd.h>
+    #define _st_write_fd write
+#endif
+
+#ifndef _ST_LOG_RING_CAPACITY
+    #define _ST_LOG_RING_CAPACITY 512
+#endif
+
+#ifndef _ST_LOG_RING_ENTRY_SIZE
+    #define _ST_LOG_RING_ENTRY_SIZE 512
+#endif
+
+struct Log_Ring_Entry {
+    u32 len;
+    char text[_ST_LOG_RING_ENTRY_SIZE - sizeof(u32)];
+};
+
+// Static so that nothing has to be allocated or locked when it is dumped from a crash handler
+Log_Ring_Entry log_ring[_ST_LOG_RING_CAPACITY];
+std::atomic<u64> log_ring_head = 0;
+
+// Keeps the last _ST_LOG_RING_CAPACITY messages (truncated to _ST_LOG_RING_ENTRY_SIZE) regardless
+// of the level of the output sinks.
+class ring_sink : public spdlog::sinks::base_sink<std::mutex> {
 public:
-    imgui_sink(Log_Context* ctx) : ctx(ctx) {}
+    ring_sink() {
+        formatter_ = std::make_unique<spdlog::pattern_formatter>("[%H:%M:%S.%e] [%l] [thread %t] %v");
+    }
 protected:
-    void sink_it_(const spdlog::details::log_msg& msg) override
-    {
+    void sink_it_(const spdlog::details::log_msg& msg) override {
         spdlog::memory_buf_t formatted;
-        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
-        ctx->entries.push_back({ fmt::to_string(formatted), msg.level });
-        ctx->has_new = true;
-    }
+        formatter_->format(msg, formatted);
 
-    void flush_() override 
-    {
-        ctx->entries.clear();
+        const u64 head = log_ring_head.load(std::memory_order_relaxed);
+        auto& entry = log_ring[head % _ST_LOG_RING_CAPACITY];
+        const size_t len = formatted.size() < sizeof(entry.text) ? formatted.size() : sizeof(entry.text);
+        memcpy(entry.text, formatted.data(), len);
+        entry.len = (u32)len;
+        log_ring_head.store(head + 1, std::memory_order_release);
     }
 
-    Log_Context* ctx;
+    void flush_() override {}
+
+    // The ring keeps its compact pattern no matter what the logger is set to
+    void set_pattern_(const std::string&) override {}
+    void set_formatter_(std::unique_ptr<spdlog::formatter>) override {}
 };
 
-void Log_Context::do_gui(Gui_Window* wnd) {
-    ImGui::DoGuiWindow(wnd, [this]() {
-        ImGui::BeginMenuBar();
-        if (ImGui::BeginMenu("Settings")) {
-            ImGui::RDragInt("Limit", &log_entry_limit, 1.f, 1, 100000);
+struct Structured_Message {
+    str_ptr_t msg;
+    std::initializer_list<Log_Field> fields;
+};
 
-            ImGui::Separator();
-            ImGui::Text("Colors");
-            for (auto& [level, color] : filter_colors) {
-                ImGui::ColorEdit4(spdlog::level::to_string_view(level).data(), color.ptr);
-            }
+// Set while a structured message passes through the sinks, which run on the logging thread
+thread_local const Structured_Message* current_structured_message = NULL;
 
-            ImGui::EndMenu();
-        }
-        if (ImGui::BeginMenu("Filter")) {
-            for (spdlog::level::level_enum level = spdlog::level::trace; level <= spdlog::level::critical; level = (spdlog::level::level_enum)((s32)level + 1)) {
-                if (level % 3 != 0) ImGui::SameLine();
-                ImGui::RCheckbox(spdlog::level::to_string_view(level).data(), &filter_flags[level]);
-            }
+template <typename Buffer>
+static void append_field_value(Buffer& buf, const Log_Field& field, bool json) {
+    switch (field.type) {
+        case LOG_FIELD_INT:    json_append_number(buf, field.i); break;
+        case LOG_FIELD_UINT:   json_append_number(buf, field.u); break;
+        case LOG_FIELD_FLOAT:  json_append_number(buf, field.f); break;
+        case LOG_FIELD_BOOL:   json_append_raw(buf, field.b ? "true" : "false"); break;
+        case LOG_FIELD_STRING: 
+            if (json) json_append_string(buf, field.s);
+            else json_append_raw(buf, field.s);
+            break;
+    }
+}
 
-            ImGui::EndMenu();
-        }
-        ImGui::EndMenuBar();
-        while (entries.size() > log_entry_limit) {
-            entries.pop_front();
-        }
-        for (auto& entry : entries) {
-            if (filter_flags[entry.level]) {
-                ImGui::TextColored(filter_colors[entry.level], "%s", str.release());
+class jsonl_sink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    jsonl_sink(std::ostream& ostr) : ostr(ostr) {}
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        spdlog::memory_buf_t line;
+
+        const auto ts = std::chrono::duration_cast<std::chrono::microseconds>(msg.time.time_since_epoch()).count();
+
+        json_append_raw(line, "{\"ts\":");
+        json_append_number(line, (s64)ts);
+        json_append_raw(line, ",\"level\":");
+        const auto level = spdlog::level::to_string_view(msg.level);
+        json_append_string(line, level.data(), level.size());
+        json_append_raw(line, ",\"logger\":");
+        json_append_string(line, msg.logger_name.data(), msg.logger_name.size());
+        json_append_raw(line, ",\"thread\":");
+        json_append_number(line, (u64)msg.thread_id);
+        json_append_raw(line, ",\"msg\":");
+
+        if (current_structured_message) {
+            json_append_string(line, current_structured_message->msg);
+            for (const auto& field : current_structured_message->fields) {
+                line.push_back(',');
+                json_append_key(line, field.key);
+                append_field_value(line, field, true);
             }
+        } else {
+            json_append_string(line, msg.payload.data(), msg.payload.size());
         }
-        if (has_new) {
-            ImGui::SetScrollHereY();
-            has_new = false;
-        }
-    }, ImGuiWindowFlags_MenuBar);
-}
 
-#include "spdlog/details/null_mutex.h"
-#include <mutex>
-using imgui_sink_mt = imgui_sink<std::mutex>;
-using imgui_sink_st = imgui_sink<spdlog::details::null_mutex>;
-*/
+        json_append_raw(line, "}\n");
+        ostr.write(line.data(), (std::streamsize)line.size());
+    }
+
+    void flush_() override {
+        ostr.flush();
+    }
+
+    std::ostream& ostr;
+};
+
 std::shared_ptr<spdlog::logger> spdlogger;
+std::shared_ptr<ring_sink> log_ring_sink;
+std::vector<spdlog::sink_ptr> output_sinks;
+std::vector<spdlog::sink_ptr> extra_sinks;
+// Holds extra_sinks, each of which checks its own level
+std::shared_ptr<spdlog::sinks::dist_sink_mt> extra_dist_sink;
+
+// Default destination of a channel. Every sink keeps its own level, so set_logger_level stays a
+// floor for the output sinks on top of the channel level.
+class channel_route_sink : public spdlog::sinks::sink {
+public:
+    void log(const spdlog::details::log_msg& msg) override {
+        for (auto& sink : output_sinks) {
+            if (sink->should_log(msg.level)) sink->log(msg);
+        }
+        if (log_ring_sink->should_log(msg.level)) log_ring_sink->log(msg);
+        extra_dist_sink->log(msg);
+    }
+
+    void flush() override {
+        for (auto& sink : output_sinks) sink->flush();
+        extra_dist_sink->flush();
+    }
+
+    // Formatting is left to the sinks it forwards to
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+};
+std::shared_ptr<channel_route_sink> log_channel_route_sink;
+
+std::atomic<u64> _log_channel_masks[spdlog::level::n_levels];
 
-void init_logger(std::ostream& ostr) {
+struct Log_Channel {
+    name_str_t name;
+    std::shared_ptr<spdlog::logger> logger;
+    std::shared_ptr<spdlog::sinks::dist_sink_mt> sinks;
+};
+
+Log_Channel log_channels[MAX_LOG_CHANNELS];
+std::atomic<u32> log_channel_count = 0;
+Profiled_Mutex log_channel_mutex("log channels");
+
+void init_logger(std::ostream& ostr, std::ostream* json_ostr) {
     
     #ifdef _ST_CONFIG_DEBUG
 		spdlog::set_pattern("%^======================================================================================================\n[%n - %l - %H:%M:%S:%e - %s - %! - Line %# - Thread %t]\n======================================================================================================%$\n%v\n");
@@ -92,9 +187,29 @@ void init_logger(std::ostream& ostr) {
     auto ostr_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(ostr, true);
     auto stdout_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
 
-    std::vector<spdlog::sink_ptr> sinks = { ostr_sink, stdout_sink };
+    log_ring_sink = std::make_shared<ring_sink>();
+    output_sinks = { ostr_sink, stdout_sink };
+    if (json_ostr) {
+        output_sinks.push_back(std::make_shared<jsonl_sink>(*json_ostr));
+    }
+
+    extra_dist_sink = std::make_shared<spdlog::sinks::dist_sink_mt>();
+    log_channel_route_sink = std::make_shared<channel_route_sink>();
+
+    std::vector<spdlog::sink_ptr> sinks = output_sinks;
+    sinks.push_back(log_ring_sink);
+    sinks.push_back(extra_dist_sink);
        
     spdlogger = spdlog::default_factory::create<spdlog::sinks::dist_sink_mt>("apparatus", sinks);
+    spdlogger->set_level(spdlog::level::trace);
+
+    register_log_channel("render");
+    register_log_channel("audio");
+    register_log_channel("io");
+
+    if (str_ptr_t spec = getenv("ST_LOG_CHANNELS")) {
+        configure_log_channels(spec);
+    }
 
     log_info("The logger has been initialized!");
 }
@@ -103,6 +218,153 @@ std::shared_ptr<spdlog::logger> _get_spdlogger() {
     return spdlogger;
 }
 
-void set_logger_level(spdlog::level::level_enum level) {
+static void update_logger_level() {
+    auto level = log_ring_sink->level();
+    for (auto& sink : output_sinks) {
+        if (sink->level() < level) level = sink->level();
+    }
+    for (auto& sink : extra_sinks) {
+        if (sink->level() < level) level = sink->level();
+    }
     spdlogger->set_level(level);
+}
+
+void set_logger_level(spdlog::level::level_enum level) {
+    for (auto& sink : output_sinks) {
+        sink->set_level(level);
+    }
+    update_logger_level();
+}
+
+void set_log_ring_level(spdlog::level::level_enum level) {
+    log_ring_sink->set_level(level);
+    update_logger_level();
+}
+
+void add_log_sink(spdlog::sink_ptr sink) {
+    extra_sinks.push_back(sink);
+    extra_dist_sink->add_sink(sink);
+    update_logger_level();
+}
+
+void remove_log_sink(spdlog::sink_ptr sink) {
+    extra_sinks.erase(std::remove(extra_sinks.begin(), extra_sinks.end(), sink), extra_sinks.end());
+    extra_dist_sink->remove_sink(sink);
+    update_logger_level();
+}
+
+log_channel_t find_log_channel(str_ptr_t name) {
+    const u32 count = log_channel_count.load(std::memory_order_acquire);
+    for (u32 i = 0; i < count; i++) {
+        if (strcmp(log_channels[i].name, name) == 0) return (log_channel_t)i;
+    }
+    return LOG_CHANNEL_INVALID;
+}
+
+log_channel_t register_log_channel(str_ptr_t name, spdlog::level::level_enum level) {
+    st_assert(spdlogger, "init_logger must be called before registering log channels");
+
+    std::lock_guard<Profiled_Mutex> lock(log_channel_mutex);
+
+    log_channel_t channel = find_log_channel(name);
+    if (channel != LOG_CHANNEL_INVALID) return channel;
+
+    const u32 count = log_channel_count.load(std::memory_order_relaxed);
+    if (count >= MAX_LOG_CHANNELS) {
+        log_error("Could not register log channel '{}', all {} channels are in use", name, MAX_LOG_CHANNELS);
+        return LOG_CHANNEL_INVALID;
+    }
+    channel = (log_channel_t)count;
+
+    auto& entry = log_channels[channel];
+    strncpy(entry.name, name, sizeof(entry.name) - 1);
+    entry.sinks = std::make_shared<spdlog::sinks::dist_sink_mt>(std::vector<spdlog::sink_ptr>{ log_channel_route_sink });
+    entry.logger = std::make_shared<spdlog::logger>(entry.name, entry.sinks);
+    entry.logger->set_level(spdlog::level::trace);
+
+    log_channel_count.store(count + 1, std::memory_order_release);
+
+    set_log_channel_level(channel, level);
+
+    return channel;
+}
+
+void set_log_channel_level(log_channel_t channel, spdlog::level::level_enum level) {
+    if (channel >= log_channel_count.load(std::memory_order_acquire)) return;
+
+    const u64 bit = 1ull << channel;
+    for (s32 i = 0; i < spdlog::level::n_levels; i++) {
+        if (i >= level && i != spdlog::level::off) _log_channel_masks[i].fetch_or(bit, std::memory_order_relaxed);
+        else _log_channel_masks[i].fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+void add_log_channel_sink(log_channel_t channel, spdlog::sink_ptr sink) {
+    if (channel >= log_channel_count.load(std::memory_order_acquire)) return;
+    log_channels[channel].sinks->add_sink(sink);
+}
+
+void set_log_channel_sinks(log_channel_t channel, std::vector<spdlog::sink_ptr> sinks) {
+    if (channel >= log_channel_count.load(std::memory_order_acquire)) return;
+    log_channels[channel].sinks->set_sinks(std::move(sinks));
+}
+
+void configure_log_channels(str_ptr_t spec) {
+    name_str_t name;
+    str16_t level_name;
+
+    while (*spec) {
+        const char* end = strchr(spec, ',');
+        if (!end) end = spec + strlen(spec);
+
+        const char* eq = (const char*)memchr(spec, '=', end - spec);
+        if (eq && (size_t)(eq - spec) < sizeof(name) && (size_t)(end - eq - 1) < sizeof(level_name)) {
+            memcpy(name, spec, eq - spec);
+            name[eq - spec] = '\0';
+            memcpy(level_name, eq + 1, end - eq - 1);
+            level_name[end - eq - 1] = '\0';
+
+            // from_str maps names it doesn't know to off
+            const auto level = spdlog::level::from_str(level_name);
+            if (level == spdlog::level::off && strcmp(level_name, "off") != 0) {
+                log_warn("Ignoring unknown log level '{}' for channel '{}'", level_name, name);
+            } else {
+                set_log_channel_level(register_log_channel(name, level), level);
+            }
+        } else {
+            log_warn("Ignoring malformed log channel spec '{}'", std::string_view(spec, end - spec));
+        }
+
+        spec = *end ? end + 1 : end;
+    }
+}
+
+spdlog::logger* _get_channel_logger(log_channel_t channel) {
+    return log_channels[channel].logger.get();
+}
+
+void _log_structured(spdlog::level::level_enum level, str_ptr_t msg, std::initializer_list<Log_Field> fields) {
+    spdlog::memory_buf_t text;
+    json_append_raw(text, msg);
+    for (const auto& field : fields) {
+        text.push_back(' ');
+        json_append_raw(text, field.key);
+        text.push_back('=');
+        append_field_value(text, field, false);
+    }
+
+    const Structured_Message structured = { msg, fields };
+    current_structured_message = &structured;
+    spdlogger->log(level, spdlog::string_view_t(text.data(), text.size()));
+    current_structured_message = NULL;
+}
+
+void dump_log_ring(int fd) {
+    const u64 head = log_ring_head.load(std::memory_order_acquire);
+    const u64 first = head > _ST_LOG_RING_CAPACITY ? head - _ST_LOG_RING_CAPACITY : 0;
+
+    for (u64 i = first; i < head; i++) {
+        const auto& entry = log_ring[i % _ST_LOG_RING_CAPACITY];
+        if (_st_write_fd(fd, entry.text, entry.len) < 0) return;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "pch.h"
+
+#include "lz4.h"
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+
+// The format requires the last 5 bytes to be literals and the last match to start 12 bytes
+// before the end
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+
+static _st_force_inline u32 read_u32(const byte_t* p) {
+    u32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static _st_force_inline u32 hash_u32(u32 value) {
+    return (value * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+static bool write_length(byte_t*& op, const byte_t* op_end, size_t length) {
+    for (; length >= 255; length -= 255) {
+        if (op >= op_end) return false;
+        *op++ = 255;
+    }
+    if (op >= op_end) return false;
+    *op++ = (byte_t)length;
+    return true;
+}
+
+// Literals followed by a match, or just literals when match_length is 0 (the last sequence)
+static bool write_sequence(byte_t*& op, const byte_t* op_end, const byte_t* literals, size_t literal_length, u16 offset, size_t match_length) {
+    if (op >= op_end) return false;
+    byte_t* token = op++;
+
+    const size_t match_code = match_length ? match_length - LZ4_MIN_MATCH : 0;
+    *token = (byte_t)((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+
+    if (literal_length >= 15 && !write_length(op, op_end, literal_length - 15)) return false;
+    if ((size_t)(op_end - op) < literal_length) return false;
+    if (literal_length) memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    if (!match_length) return true;
+
+    if (op_end - op < 2) return false;
+    *op++ = (byte_t)(offset & 0xFF);
+    *op++ = (byte_t)(offset >> 8);
+
+    if (match_code >= 15 && !write_length(op, op_end, match_code - 15)) return false;
+    return true;
+}
+
+size_t lz4_compress(const byte_t* src, size_t src_size, byte_t* dst, size_t dst_capacity) {
+    byte_t* op = dst;
+    const byte_t* op_end = dst + dst_capacity;
+
+    const byte_t* ip = src;
+    const byte_t* anchor = src;
+    const byte_t* end = src + src_size;
+
+    if (src_size > LZ4_MATCH_FIND_LIMIT) {
+        // Positions + 1, 0 means empty
+        u32 table[1 << LZ4_HASH_BITS] = {};
+
+        const byte_t* match_find_limit = end - LZ4_MATCH_FIND_LIMIT;
+        const byte_t* match_end_limit = end - LZ4_LAST_LITERALS;
+
+        while (ip < match_find_limit) {
+            const u32 sequence = read_u32(ip);
+            const u32 hash = hash_u32(sequence);
+            const u32 candidate = table[hash];
+            table[hash] = (u32)(ip - src) + 1;
+
+            const byte_t* ref = candidate ? src + candidate - 1 : NULL;
+            if (!ref || ip - ref > LZ4_MAX_OFFSET || read_u32(ref) != sequence) {
+                // Skip faster through data that doesn't compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // Extend backwards into pending literals, then forwards
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            size_t match_length = LZ4_MIN_MATCH;
+            while (ip + match_length < match_end_limit && ip[match_length] == ref[match_length]) match_length++;
+
+            if (!write_sequence(op, op_end, anchor, ip - anchor, (u16)(ip - ref), match_length)) return 0;
+
+            ip += match_length;
+            anchor = ip;
+        }
+    }
+
+    if (!write_sequence(op, op_end, anchor, end - anchor, 0, 0)) return 0;
+    return op - dst;
+}
+
+static bool read_length(const byte_t*& ip, const byte_t* ip_end, size_t* length) {
+    byte_t byte;
+    do {
+        if (ip >= ip_end) return false;
+        byte = *ip++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+s64 lz4_decompress(const byte_t* src, size_t src_size, byte_t* dst, size_t dst_capacity) {
+    const byte_t* ip = src;
+    const byte_t* ip_end = src + src_size;
+    byte_t* op = dst;
+    const byte_t* op_end = dst + dst_capacity;
+
+    while (ip < ip_end) {
+        const byte_t token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(ip, ip_end, &literal_length)) return -1;
+        if ((size_t)(ip_end - ip) < literal_length || (size_t)(op_end - op) < literal_length) return -1;
+        if (literal_length) memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        // The last sequence has no match
+        if (ip == ip_end) break;
+
+        if (ip_end - ip < 2) return -1;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return -1;
+
+        size_t match_length = token & 15;
+        if (match_length == 15 && !read_length(ip, ip_end, &match_length)) return -1;
+        match_length += LZ4_MIN_MATCH;
+        if ((size_t)(op_end - op) < match_length) return -1;
+
+        // Matches may overlap the bytes they produce
+        const byte_t* match = op - offset;
+        if (offset >= match_length) {
+            memcpy(op, match, match_length);
+            op += match_length;
+        } else {
+            for (size_t i = 0; i < match_length; i++) *op++ = match[i];
+        }
+    }
+
+    return op - dst;
+}
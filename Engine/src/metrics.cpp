@@ -0,0 +1,157 @@
+#include "pch.h"
+
+#include "metrics.h"
+#include "logger.h"
+#include "json.h"
+#include "profiled_mutex.h"
+
+#include <chrono>
+
+Metric_Counter metric_counters[MAX_METRICS];
+Metric_Gauge metric_gauges[MAX_METRICS];
+Metric_Histogram metric_histograms[MAX_METRICS];
+
+std::atomic<u32> metric_counter_count = 0;
+std::atomic<u32> metric_gauge_count = 0;
+std::atomic<u32> metric_histogram_count = 0;
+
+Profiled_Mutex metrics_mutex("metrics");
+
+FILE* metrics_file = NULL;
+u32 metrics_snapshot_interval = 0;
+u64 metrics_frame = 0;
+u64 metrics_last_snapshot_frame = ~0ull;
+
+const f64 default_histogram_bounds[] = { 0.1, 0.2, 0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000 };
+
+static_assert(sizeof(default_histogram_bounds) / sizeof(f64) <= METRIC_MAX_BUCKETS);
+
+template <typename T>
+static T* find_or_add(T* metrics, std::atomic<u32>& count, str_ptr_t name, bool* added) {
+    *added = false;
+
+    const u32 n = count.load(std::memory_order_acquire);
+    for (u32 i = 0; i < n; i++) {
+        if (strcmp(metrics[i].name, name) == 0) return &metrics[i];
+    }
+    if (n >= MAX_METRICS) {
+        log_error_once("Could not register metric '{}', all {} slots are in use", name, MAX_METRICS);
+        return NULL;
+    }
+
+    auto metric = &metrics[n];
+    strncpy(metric->name, name, sizeof(metric->name) - 1);
+    *added = true;
+    return metric;
+}
+
+Metric_Counter* get_counter(str_ptr_t name) {
+    std::lock_guard<Profiled_Mutex> lock(metrics_mutex);
+    bool added;
+    auto counter = find_or_add(metric_counters, metric_counter_count, name, &added);
+    if (added) metric_counter_count.fetch_add(1, std::memory_order_release);
+    return counter;
+}
+
+Metric_Gauge* get_gauge(str_ptr_t name) {
+    std::lock_guard<Profiled_Mutex> lock(metrics_mutex);
+    bool added;
+    auto gauge = find_or_add(metric_gauges, metric_gauge_count, name, &added);
+    if (added) metric_gauge_count.fetch_add(1, std::memory_order_release);
+    return gauge;
+}
+
+Metric_Histogram* get_histogram(str_ptr_t name, std::initializer_list<f64> bounds) {
+    std::lock_guard<Profiled_Mutex> lock(metrics_mutex);
+    bool added;
+    auto histogram = find_or_add(metric_histograms, metric_histogram_count, name, &added);
+    if (!added) return histogram;
+
+    const f64* src = bounds.size() ? bounds.begin() : default_histogram_bounds;
+    size_t src_count = bounds.size() ? bounds.size() : sizeof(default_histogram_bounds) / sizeof(f64);
+    if (src_count > METRIC_MAX_BUCKETS) src_count = METRIC_MAX_BUCKETS;
+
+    memcpy(histogram->bounds, src, src_count * sizeof(f64));
+    histogram->bucket_count = (u32)src_count;
+
+    metric_histogram_count.fetch_add(1, std::memory_order_release);
+    return histogram;
+}
+
+bool init_metrics(str_ptr_t path, u32 snapshot_interval) {
+    shutdown_metrics();
+
+    metrics_file = fopen(path, "ab");
+    if (!metrics_file) {
+        log_error("Could not open metrics file '{}'", path);
+        return false;
+    }
+    metrics_snapshot_interval = snapshot_interval ? snapshot_interval : 1;
+    return true;
+}
+
+void shutdown_metrics() {
+    if (!metrics_file) return;
+    if (metrics_last_snapshot_frame != metrics_frame) write_metrics_snapshot();
+    fclose(metrics_file);
+    metrics_file = NULL;
+}
+
+void metrics_frame_end() {
+    metrics_frame++;
+    if (metrics_file && metrics_frame % metrics_snapshot_interval == 0) {
+        write_metrics_snapshot();
+    }
+}
+
+void write_metrics_snapshot() {
+    if (!metrics_file) return;
+
+    spdlog::memory_buf_t buf;
+
+    const auto ts = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    fmt::format_to(std::back_inserter(buf), "{{\"ts\":{},\"frame\":{},\"counters\":{{", ts, metrics_frame);
+
+    const u32 counter_count = metric_counter_count.load(std::memory_order_acquire);
+    for (u32 i = 0; i < counter_count; i++) {
+        if (i > 0) buf.push_back(',');
+        json_append_key(buf, metric_counters[i].name);
+        json_append_number(buf, metric_counters[i].value());
+    }
+
+    json_append_raw(buf, "},\"gauges\":{");
+    const u32 gauge_count = metric_gauge_count.load(std::memory_order_acquire);
+    for (u32 i = 0; i < gauge_count; i++) {
+        if (i > 0) buf.push_back(',');
+        json_append_key(buf, metric_gauges[i].name);
+        json_append_number(buf, metric_gauges[i].value.load(std::memory_order_relaxed));
+    }
+
+    json_append_raw(buf, "},\"histograms\":{");
+    const u32 histogram_count = metric_histogram_count.load(std::memory_order_acquire);
+    for (u32 i = 0; i < histogram_count; i++) {
+        const auto& histogram = metric_histograms[i];
+        if (i > 0) buf.push_back(',');
+        json_append_key(buf, histogram.name);
+        json_append_raw(buf, "{\"count\":");
+        json_append_number(buf, histogram.count.load(std::memory_order_relaxed));
+        json_append_raw(buf, ",\"sum\":");
+        json_append_number(buf, histogram.sum.load(std::memory_order_relaxed));
+        json_append_raw(buf, ",\"buckets\":[");
+        for (u32 bucket = 0; bucket <= histogram.bucket_count; bucket++) {
+            if (bucket > 0) buf.push_back(',');
+            json_append_raw(buf, "{\"le\":");
+            if (bucket < histogram.bucket_count) json_append_number(buf, histogram.bounds[bucket]);
+            else json_append_raw(buf, "\"inf\"");
+            json_append_raw(buf, ",\"count\":");
+            json_append_number(buf, histogram.buckets[bucket].load(std::memory_order_relaxed));
+            buf.push_back('}');
+        }
+        json_append_raw(buf, "]}");
+    }
+    json_append_raw(buf, "}}\n");
+
+    fwrite(buf.data(), 1, buf.size(), metrics_file);
+    fflush(metrics_file);
+    metrics_last_snapshot_frame = metrics_frame;
+}
@@ -0,0 +1,311 @@
+#include "pch.h"
+
+#include "os/async_io.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+enum Async_Request_State : u8 {
+    ASYNC_REQUEST_FREE,
+    ASYNC_REQUEST_QUEUED,    // Waiting for submit
+    ASYNC_REQUEST_SUBMITTED, // Owned by the backend
+    ASYNC_REQUEST_RUNNING,   // Being executed by a worker, can't be cancelled
+    ASYNC_REQUEST_DONE,      // Waiting for poll to run the callback
+};
+
+struct Async_Io_State {
+    Async_Request* requests = NULL;
+    u32* free_slots = NULL;
+    u32 free_count = 0;
+    u32* queued = NULL;
+    u32 queued_count = 0;
+    u32 queue_depth = 0;
+    u32 in_flight = 0;
+    u32 next_sequence = 1;
+
+    // Finished requests whose callbacks haven't run yet, only touched by the owning thread
+    Deque<u32> completed;
+
+    _Async_Kernel_Queue* kernel_queue = NULL;
+
+    // Thread pool fallback
+    std::thread* workers = NULL;
+    u32 worker_count = 0;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    Deque<u32> work;
+    Deque<u32> done;
+    bool stopping = false;
+};
+
+static void worker_loop(Async_Io_State* state) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (true) {
+        state->work_cv.wait(lock, [state] { return state->stopping || !state->work.empty(); });
+        if (state->work.empty()) return;
+
+        const u32 slot = state->work.front();
+        state->work.pop_front();
+
+        auto& request = state->requests[slot];
+        request.state = ASYNC_REQUEST_RUNNING;
+        lock.unlock();
+
+        const s64 bytes = request.op == ASYNC_OP_READ
+            ? request.file->read_at(request.buffer, request.size, request.offset)
+            : request.file->write_at(request.buffer, request.size, request.offset);
+
+        lock.lock();
+        request.bytes = bytes < 0 ? 0 : bytes;
+        request.status = bytes < 0 ? IO_STATUS_UNKNOWN_ERROR : IO_STATUS_OK;
+        request.state = ASYNC_REQUEST_DONE;
+        state->done.push_back(slot);
+        state->done_cv.notify_one();
+    }
+}
+
+static void kernel_complete(Async_Request* request, s64 bytes, Io_Status status, void* context) {
+    auto state = (Async_Io_State*)context;
+    const u32 slot = (u32)(request - state->requests);
+    request->bytes += bytes;
+
+    // Transfers are capped and may come back short, continue like File::read_at/write_at would.
+    // Nothing transferred means end of file.
+    if (status == IO_STATUS_OK && bytes > 0 && (size_t)request->bytes < request->size) {
+        if (_async_kernel_queue_push(state->kernel_queue, request)) return;
+
+        // Submission ring is full, the next submit pushes it again
+        request->state = ASYNC_REQUEST_QUEUED;
+        state->queued[state->queued_count++] = slot;
+        return;
+    }
+
+    request->status = status;
+    request->state = ASYNC_REQUEST_DONE;
+    state->completed.push_back(slot);
+}
+
+Async_Io::Async_Io(u32 queue_depth, u32 fallback_threads) {
+    if (queue_depth == 0) {
+        _status = IO_STATUS_INVALID_ARGUMENT;
+        return;
+    }
+
+    __state = new Async_Io_State();
+    __state->queue_depth = queue_depth;
+    __state->requests = (Async_Request*)calloc(queue_depth, sizeof(Async_Request));
+    __state->free_slots = (u32*)malloc(queue_depth * sizeof(u32));
+    __state->queued = (u32*)malloc(queue_depth * sizeof(u32));
+    if (!__state->requests || !__state->free_slots || !__state->queued) {
+        _status = IO_STATUS_OUT_OF_MEMORY;
+        return;
+    }
+
+    // Hand out low slots first
+    for (u32 i = 0; i < queue_depth; i++) __state->free_slots[i] = queue_depth - 1 - i;
+    __state->free_count = queue_depth;
+
+    __state->kernel_queue = _async_kernel_queue_create(queue_depth);
+    if (!__state->kernel_queue) {
+        __state->worker_count = fallback_threads ? fallback_threads : 1;
+        __state->workers = new std::thread[__state->worker_count];
+        for (u32 i = 0; i < __state->worker_count; i++) {
+            __state->workers[i] = std::thread(worker_loop, __state);
+        }
+    }
+
+    _status = IO_STATUS_OK;
+}
+
+Async_Io::~Async_Io() {
+    if (!__state) return;
+
+    if (_status == IO_STATUS_OK) drain();
+
+    if (__state->workers) {
+        {
+            std::lock_guard<std::mutex> lock(__state->mutex);
+            __state->stopping = true;
+        }
+        __state->work_cv.notify_all();
+        for (u32 i = 0; i < __state->worker_count; i++) __state->workers[i].join();
+        delete[] __state->workers;
+    }
+    if (__state->kernel_queue) _async_kernel_queue_destroy(__state->kernel_queue);
+
+    free(__state->requests);
+    free(__state->free_slots);
+    free(__state->queued);
+    delete __state;
+}
+
+static async_request_t enqueue(Async_Io_State* state, Async_Op op, const File& file, void* buffer, size_t size, u64 offset, async_callback_t callback, void* user_data) {
+    if (state->free_count == 0) return 0;
+
+    const u32 slot = state->free_slots[--state->free_count];
+    auto& request = state->requests[slot];
+
+    request.id = ((u64)state->next_sequence++ << 32) | slot;
+    if (state->next_sequence == 0) state->next_sequence = 1;
+
+    request.op = op;
+    request.file = &file;
+    request.buffer = buffer;
+    request.size = size;
+    request.offset = offset;
+    request.callback = callback;
+    request.user_data = user_data;
+    request.bytes = 0;
+    request.status = IO_STATUS_UNSET;
+    request.state = ASYNC_REQUEST_QUEUED;
+
+    state->queued[state->queued_count++] = slot;
+    state->in_flight++;
+    return request.id;
+}
+
+async_request_t Async_Io::read(const File& file, void* buffer, size_t size, u64 offset, async_callback_t callback, void* user_data) {
+    if (_status != IO_STATUS_OK || file._status != IO_STATUS_OK) return 0;
+    return enqueue(__state, ASYNC_OP_READ, file, buffer, size, offset, callback, user_data);
+}
+
+async_request_t Async_Io::write(const File& file, const void* buffer, size_t size, u64 offset, async_callback_t callback, void* user_data) {
+    if (_status != IO_STATUS_OK || file._status != IO_STATUS_OK) return 0;
+    return enqueue(__state, ASYNC_OP_WRITE, file, (void*)buffer, size, offset, callback, user_data);
+}
+
+u32 Async_Io::submit() {
+    if (_status != IO_STATUS_OK || __state->queued_count == 0) return 0;
+
+    u32 submitted = 0;
+    if (__state->kernel_queue) {
+        // Stops early if the submission ring is full, the rest goes with the next submit
+        while (submitted < __state->queued_count) {
+            auto& request = __state->requests[__state->queued[submitted]];
+            if (!_async_kernel_queue_push(__state->kernel_queue, &request)) break;
+            request.state = ASYNC_REQUEST_SUBMITTED;
+            submitted++;
+        }
+        _async_kernel_queue_submit(__state->kernel_queue);
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(__state->mutex);
+            for (; submitted < __state->queued_count; submitted++) {
+                const u32 slot = __state->queued[submitted];
+                __state->requests[slot].state = ASYNC_REQUEST_SUBMITTED;
+                __state->work.push_back(slot);
+            }
+        }
+        __state->work_cv.notify_all();
+    }
+
+    __state->queued_count -= submitted;
+    memmove(__state->queued, __state->queued + submitted, __state->queued_count * sizeof(u32));
+    return submitted;
+}
+
+u32 Async_Io::poll(bool wait) {
+    if (_status != IO_STATUS_OK) return 0;
+
+    // Only block on requests a backend is actually working on
+    const bool can_block = wait && __state->completed.empty() && __state->in_flight > __state->queued_count;
+
+    if (__state->kernel_queue) {
+        _async_kernel_queue_reap(__state->kernel_queue, can_block, kernel_complete, __state);
+    } else {
+        std::unique_lock<std::mutex> lock(__state->mutex);
+        if (can_block) __state->done_cv.wait(lock, [this] { return !__state->done.empty(); });
+        for (u32 slot : __state->done) __state->completed.push_back(slot);
+        __state->done.clear();
+    }
+
+    u32 callbacks = 0;
+    while (!__state->completed.empty()) {
+        const u32 slot = __state->completed.front();
+        __state->completed.pop_front();
+
+        auto& request = __state->requests[slot];
+        const Async_Result result = { request.id, request.status, request.bytes, request.buffer, request.user_data };
+        const async_callback_t callback = request.callback;
+
+        // Free the slot first so the callback can queue follow up requests
+        request.state = ASYNC_REQUEST_FREE;
+        __state->free_slots[__state->free_count++] = slot;
+        __state->in_flight--;
+
+        if (callback) callback(result);
+        callbacks++;
+    }
+    return callbacks;
+}
+
+void Async_Io::drain() {
+    while (__state->in_flight > 0) {
+        submit();
+        poll(true);
+    }
+}
+
+bool Async_Io::cancel(async_request_t id) {
+    if (_status != IO_STATUS_OK || id == 0) return false;
+
+    const u32 slot = (u32)(id & 0xFFFFFFFF);
+    if (slot >= __state->queue_depth) return false;
+
+    // Workers change request states under the lock
+    std::unique_lock<std::mutex> lock(__state->mutex, std::defer_lock);
+    if (!__state->kernel_queue) lock.lock();
+
+    auto& request = __state->requests[slot];
+    if (request.id != id) return false;
+
+    switch (request.state) {
+        case ASYNC_REQUEST_QUEUED: {
+            for (u32 i = 0; i < __state->queued_count; i++) {
+                if (__state->queued[i] != slot) continue;
+                memmove(__state->queued + i, __state->queued + i + 1, (__state->queued_count - i - 1) * sizeof(u32));
+                __state->queued_count--;
+                break;
+            }
+            request.status = IO_STATUS_CANCELLED;
+            request.state = ASYNC_REQUEST_DONE;
+            __state->completed.push_back(slot);
+            return true;
+        }
+        case ASYNC_REQUEST_SUBMITTED: {
+            if (__state->kernel_queue) {
+                if (!_async_kernel_queue_push_cancel(__state->kernel_queue, &request)) return false;
+                _async_kernel_queue_submit(__state->kernel_queue);
+                return true;
+            }
+
+            for (auto it = __state->work.begin(); it != __state->work.end(); ++it) {
+                if (*it != slot) continue;
+                __state->work.erase(it);
+                request.status = IO_STATUS_CANCELLED;
+                request.state = ASYNC_REQUEST_DONE;
+                __state->completed.push_back(slot);
+                return true;
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+u32 Async_Io::get_in_flight() const {
+    return __state ? __state->in_flight : 0;
+}
+
+bool Async_Io::is_kernel_backed() const {
+    return __state && __state->kernel_queue;
+}
+
+NS_END(io)
+NS_END(os)
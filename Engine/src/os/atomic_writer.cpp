@@ -0,0 +1,152 @@
+#include "pch.h"
+
+#include "os/atomic_writer.h"
+
+#include <atomic>
+#include <chrono>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+#define MAX_TEMP_ATTEMPTS 16
+
+struct Atomic_File_Writer_State {
+    path_str_t path;
+    path_str_t temp_path;
+    File* temp = NULL;
+
+    byte_t* batch = NULL;
+    size_t batch_size = 0;
+    size_t batched = 0;
+
+    // Bytes already in the temporary file
+    u64 flushed = 0;
+};
+
+static std::atomic<u32> temp_counter = 0;
+
+static File* create_temp(Atomic_File_Writer_State* state, Io_Status* status) {
+    // Unique within the process through the counter, between processes through the clock
+    const u64 seed = (u64)std::chrono::steady_clock::now().time_since_epoch().count();
+
+    for (u32 attempt = 0; attempt < MAX_TEMP_ATTEMPTS; attempt++) {
+        const u64 unique = seed ^ ((u64)temp_counter.fetch_add(1) << 40);
+        const int written = snprintf(state->temp_path, sizeof(state->temp_path), "%s.%llx.tmp", state->path, (unsigned long long)unique);
+        if (written < 0 || (size_t)written >= sizeof(state->temp_path)) {
+            *status = IO_STATUS_INVALID_ARGUMENT;
+            return NULL;
+        }
+
+        auto file = new File(state->temp_path, FILE_ACCESS_WRITE, FILE_FLAG_CREATE | FILE_FLAG_EXCLUSIVE);
+        *status = file->_status;
+        if (file->_status == IO_STATUS_OK) return file;
+
+        delete file;
+        if (*status != IO_STATUS_ALREADY_EXISTS) return NULL;
+    }
+    return NULL;
+}
+
+static bool flush_batch(Atomic_File_Writer_State* state) {
+    if (state->batched == 0) return true;
+
+    if (state->temp->write_at(state->batch, state->batched, state->flushed) != (s64)state->batched) return false;
+    state->flushed += state->batched;
+    state->batched = 0;
+    return true;
+}
+
+Atomic_File_Writer::Atomic_File_Writer(str_ptr_t path, u64 expected_size, size_t batch_size) {
+    __state = new Atomic_File_Writer_State();
+    if (!path || !path[0] || strlen(path) >= sizeof(__state->path)) {
+        _status = IO_STATUS_INVALID_ARGUMENT;
+        return;
+    }
+    strcpy(__state->path, path);
+
+    __state->batch_size = batch_size;
+    if (batch_size > 0) {
+        __state->batch = (byte_t*)malloc(batch_size);
+        if (!__state->batch) {
+            _status = IO_STATUS_OUT_OF_MEMORY;
+            return;
+        }
+    }
+
+    __state->temp = create_temp(__state, &_status);
+    if (!__state->temp) return;
+
+    if (expected_size > 0) __state->temp->preallocate(expected_size);
+}
+
+Atomic_File_Writer::~Atomic_File_Writer() {
+    if (__state->temp) {
+        delete __state->temp;
+        remove_file(__state->temp_path);
+    }
+    free(__state->batch);
+    delete __state;
+}
+
+bool Atomic_File_Writer::write(const void* data, size_t size) {
+    // No temporary file left means it was committed already
+    if (_status != IO_STATUS_OK || !__state->temp) return false;
+
+    auto state = __state;
+    if (state->batched + size <= state->batch_size) {
+        if (size > 0) memcpy(state->batch + state->batched, data, size);
+        state->batched += size;
+        return true;
+    }
+
+    // Too big to batch, write it straight after whatever is pending
+    if (!flush_batch(state)) {
+        _status = IO_STATUS_UNKNOWN_ERROR;
+        return false;
+    }
+    if (size < state->batch_size) {
+        memcpy(state->batch, data, size);
+        state->batched = size;
+        return true;
+    }
+
+    if (state->temp->write_at(data, size, state->flushed) != (s64)size) {
+        _status = IO_STATUS_UNKNOWN_ERROR;
+        return false;
+    }
+    state->flushed += size;
+    return true;
+}
+
+Io_Status Atomic_File_Writer::commit() {
+    if (_status != IO_STATUS_OK) return _status;
+    if (!__state->temp) return IO_STATUS_INVALID_ARGUMENT;
+
+    auto state = __state;
+    const bool written = flush_batch(state) && state->temp->sync();
+
+    // Closed before the rename, Windows can't replace an open file
+    delete state->temp;
+    state->temp = NULL;
+
+    if (!written || !replace_file(state->temp_path, state->path)) {
+        remove_file(state->temp_path);
+        _status = IO_STATUS_UNKNOWN_ERROR;
+        return _status;
+    }
+    return IO_STATUS_OK;
+}
+
+u64 Atomic_File_Writer::get_written() const {
+    return __state->flushed + __state->batched;
+}
+
+Io_Status write_file_atomic(str_ptr_t path, const void* data, size_t size) {
+    // Nothing to batch, the data goes to the file in one write
+    Atomic_File_Writer writer(path, size, 0);
+    if (!writer.write(data, size)) return writer._status;
+    return writer.commit();
+}
+
+NS_END(io)
+NS_END(os)
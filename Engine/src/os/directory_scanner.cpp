@@ -0,0 +1,189 @@
+#include "pch.h"
+
+#include "os/directory_scanner.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+#define DIR_ARENA_BLOCK_SIZE (1024 * 1024)
+
+struct Dir_Arena_Block {
+    Dir_Arena_Block* next;
+    size_t used;
+    size_t capacity;
+};
+
+struct Dir_Scan_Worker {
+    struct Dir_Scan_State* state;
+
+    Dir_Arena_Block* arena = NULL;
+    std::vector<Dir_Entry> entries;
+    std::vector<str_ptr_t> subdirectories;
+    u32 errors = 0;
+
+    // Directory being read
+    str_ptr_t directory;
+    size_t directory_length;
+};
+
+struct Dir_Scan_State {
+    void* root;
+    path_str_t root_path;
+    u32 flags;
+
+    Dir_Scan_Worker* workers = NULL;
+    u32 worker_count = 0;
+    Dir_Entry* entries = NULL;
+
+    // Directories waiting to be read, shared by the workers
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<str_ptr_t> queue;
+    u32 busy = 0;
+};
+
+static char* arena_alloc(Dir_Scan_Worker* worker, size_t size) {
+    Dir_Arena_Block* block = worker->arena;
+    if (!block || block->capacity - block->used < size) {
+        const size_t capacity = std::max<size_t>(DIR_ARENA_BLOCK_SIZE, size);
+        block = (Dir_Arena_Block*)malloc(sizeof(Dir_Arena_Block) + capacity);
+        if (!block) return NULL;
+        block->next = worker->arena;
+        block->used = 0;
+        block->capacity = capacity;
+        worker->arena = block;
+    }
+
+    char* result = (char*)(block + 1) + block->used;
+    block->used += size;
+    return result;
+}
+
+static void emit_entry(void* context, str_ptr_t name, size_t name_length, Dir_Entry_Type type, u64 size, u64 modified_ns) {
+    auto worker = (Dir_Scan_Worker*)context;
+    const u32 flags = worker->state->flags;
+
+    const bool descend = type == DIR_ENTRY_DIRECTORY && (flags & DIR_SCAN_RECURSIVE);
+    const bool report = type != DIR_ENTRY_DIRECTORY || !(flags & DIR_SCAN_FILES_ONLY);
+    if (!descend && !report) return;
+
+    const size_t separator = worker->directory_length > 0 ? 1 : 0;
+    const size_t path_length = worker->directory_length + separator + name_length;
+
+    char* path = arena_alloc(worker, path_length + 1);
+    if (!path) {
+        worker->errors++;
+        return;
+    }
+    memcpy(path, worker->directory, worker->directory_length);
+    if (separator) path[worker->directory_length] = '/';
+    memcpy(path + worker->directory_length + separator, name, name_length);
+    path[path_length] = '\0';
+
+    if (report) worker->entries.push_back({ path, (u32)path_length, type, size, modified_ns });
+    if (descend) worker->subdirectories.push_back(path);
+}
+
+static void worker_loop(Dir_Scan_Worker* worker) {
+    auto state = worker->state;
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (true) {
+        state->cv.wait(lock, [state] { return !state->queue.empty() || state->busy == 0; });
+        if (state->queue.empty()) return;
+
+        // Depth first keeps the queue small
+        worker->directory = state->queue.back();
+        state->queue.pop_back();
+        state->busy++;
+        lock.unlock();
+
+        worker->directory_length = strlen(worker->directory);
+        if (!_dir_scan_read(state->root, state->root_path, worker->directory, state->flags, emit_entry, worker)) worker->errors++;
+
+        lock.lock();
+        state->queue.insert(state->queue.end(), worker->subdirectories.rbegin(), worker->subdirectories.rend());
+        worker->subdirectories.clear();
+        state->busy--;
+        state->cv.notify_all();
+    }
+}
+
+Dir_Scan::Dir_Scan(str_ptr_t root, u32 flags, u32 threads) {
+    __state = new Dir_Scan_State();
+    __state->flags = flags;
+    snprintf(__state->root_path, sizeof(__state->root_path), "%s", root);
+    __state->root = _dir_scan_open_root(root);
+    if (!__state->root) {
+        _status = IO_STATUS_FILE_NOT_FOUND;
+        return;
+    }
+
+    __state->worker_count = (flags & DIR_SCAN_RECURSIVE) && threads > 1 ? threads : 1;
+    __state->workers = new Dir_Scan_Worker[__state->worker_count];
+    for (u32 i = 0; i < __state->worker_count; i++) __state->workers[i].state = __state;
+
+    __state->queue.push_back("");
+
+    if (__state->worker_count == 1) {
+        worker_loop(&__state->workers[0]);
+    } else {
+        std::vector<std::thread> threads_;
+        for (u32 i = 1; i < __state->worker_count; i++) threads_.emplace_back(worker_loop, &__state->workers[i]);
+        worker_loop(&__state->workers[0]);
+        for (auto& thread : threads_) thread.join();
+    }
+
+    _dir_scan_close_root(__state->root);
+    __state->root = NULL;
+
+    // Merge the per worker entries into one block
+    u32 total = 0;
+    for (u32 i = 0; i < __state->worker_count; i++) {
+        total += (u32)__state->workers[i].entries.size();
+        error_count += __state->workers[i].errors;
+    }
+
+    if (__state->worker_count == 1) {
+        entries = __state->workers[0].entries.data();
+    } else if (total > 0) {
+        __state->entries = (Dir_Entry*)malloc(total * sizeof(Dir_Entry));
+        if (!__state->entries) {
+            _status = IO_STATUS_OUT_OF_MEMORY;
+            return;
+        }
+
+        u32 offset = 0;
+        for (u32 i = 0; i < __state->worker_count; i++) {
+            auto& worker_entries = __state->workers[i].entries;
+            if (!worker_entries.empty()) memcpy(__state->entries + offset, worker_entries.data(), worker_entries.size() * sizeof(Dir_Entry));
+            offset += (u32)worker_entries.size();
+            std::vector<Dir_Entry>().swap(worker_entries);
+        }
+        entries = __state->entries;
+    }
+    entry_count = total;
+
+    // The root itself failing to open means nothing was scanned
+    _status = error_count > 0 && total == 0 ? IO_STATUS_ACCESS_DENIED : IO_STATUS_OK;
+}
+
+Dir_Scan::~Dir_Scan() {
+    for (u32 i = 0; i < __state->worker_count; i++) {
+        for (Dir_Arena_Block* block = __state->workers[i].arena; block;) {
+            Dir_Arena_Block* next = block->next;
+            free(block);
+            block = next;
+        }
+    }
+    delete[] __state->workers;
+    free(__state->entries);
+    delete __state;
+}
+
+NS_END(io)
+NS_END(os)
@@ -0,0 +1,118 @@
+#include "pch.h"
+
+#include "os/file_watcher.h"
+
+#include <chrono>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+struct File_Watch_Subscriber {
+    u32 id;
+    Dynamic_String path_prefix;
+    file_change_fn_t fn;
+    void* user_data;
+};
+
+struct File_Watch_Pending {
+    u32 changes;
+    u64 last_event_ms;
+};
+
+struct File_Watcher_State {
+    _File_Watch_Queue* queue = NULL;
+    std::vector<File_Watch_Subscriber> subscribers;
+    u32 next_subscriber_id = 1;
+
+    Hash_Map<Dynamic_String, File_Watch_Pending> pending;
+    u64 now_ms = 0;
+};
+
+static u64 steady_ms() {
+    return (u64)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void add_pending(str_ptr_t path, u32 changes, void* context) {
+    auto state = (File_Watcher_State*)context;
+    auto& pending = state->pending[path];
+    pending.changes |= changes;
+    pending.last_event_ms = state->now_ms;
+}
+
+static bool is_subscribed(const File_Watcher_State* state, u32 id) {
+    for (const auto& subscriber : state->subscribers) {
+        if (subscriber.id == id) return true;
+    }
+    return false;
+}
+
+File_Watcher::File_Watcher() {
+    __state = new File_Watcher_State();
+    __state->queue = _file_watch_queue_create();
+    _status = __state->queue ? IO_STATUS_OK : IO_STATUS_UNKNOWN_ERROR;
+}
+
+File_Watcher::~File_Watcher() {
+    if (__state->queue) _file_watch_queue_destroy(__state->queue);
+    delete __state;
+}
+
+bool File_Watcher::watch(str_ptr_t directory, bool recursive) {
+    if (_status != IO_STATUS_OK) return false;
+    return _file_watch_queue_add(__state->queue, directory, recursive);
+}
+
+u32 File_Watcher::subscribe(str_ptr_t path_prefix, file_change_fn_t fn, void* user_data) {
+    if (_status != IO_STATUS_OK || !fn) return 0;
+
+    const u32 id = __state->next_subscriber_id++;
+    __state->subscribers.push_back({ id, path_prefix ? path_prefix : "", fn, user_data });
+    return id;
+}
+
+void File_Watcher::unsubscribe(u32 subscription) {
+    auto& subscribers = __state->subscribers;
+    for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+        if (it->id != subscription) continue;
+        subscribers.erase(it);
+        return;
+    }
+}
+
+u32 File_Watcher::poll() {
+    if (_status != IO_STATUS_OK) return 0;
+
+    __state->now_ms = steady_ms();
+    _file_watch_queue_read(__state->queue, add_pending, __state);
+    if (__state->pending.empty()) return 0;
+
+    // Copy the subscribers so callbacks can subscribe and unsubscribe
+    const std::vector<File_Watch_Subscriber> subscribers = __state->subscribers;
+
+    u32 dispatched = 0;
+    for (auto it = __state->pending.begin(); it != __state->pending.end();) {
+        if (__state->now_ms - it->second.last_event_ms < settle_ms) {
+            ++it;
+            continue;
+        }
+
+        File_Change_Event event;
+        strncpy(event.path, it->first.c_str(), sizeof(event.path) - 1);
+        event.path[sizeof(event.path) - 1] = '\0';
+        event.changes = it->second.changes;
+        it = __state->pending.erase(it);
+
+        for (const auto& subscriber : subscribers) {
+            // An earlier callback may have unsubscribed it
+            if (!is_subscribed(__state, subscriber.id)) continue;
+            if (strncmp(event.path, subscriber.path_prefix.c_str(), subscriber.path_prefix.size()) == 0) {
+                subscriber.fn(event, subscriber.user_data);
+            }
+        }
+        dispatched++;
+    }
+    return dispatched;
+}
+
+NS_END(io)
+NS_END(os)
@@ -5,31 +5,179 @@
 NS_BEGIN(os)
 NS_BEGIN(io)
 
-New_String ST_API get_directory(str_ptr_t path) {
-    // Find the last occurrence of / or \\ in the path
-    const char* lastSlash = strrchr(path, '/');
-    const char* lastBackSlash = strrchr(path, '\\');
-    const char* lastSeparator = (lastSlash > lastBackSlash) ? lastSlash : lastBackSlash;
-
-    if (lastSeparator == nullptr) {
-        // No slashes found, return an empty string
-        return New_String("");
+static _st_force_inline bool is_separator(char c) {
+    return c == '/' || c == '\\';
+}
+
+static size_t find_last_separator(std::string_view path) {
+    for (size_t i = path.size(); i-- > 0;) {
+        if (is_separator(path[i])) return i;
     }
+    return std::string_view::npos;
+}
 
-    // Calculate the length of the directory path and create a new string
-    size_t directoryLength = lastSeparator - path;
-    New_String directory(directoryLength);
+// Length of "/", "C:" or "C:/" at the start of the path
+static size_t root_length(std::string_view path) {
+    if (path.size() >= 2 && path[1] == ':' && ((path[0] >= 'a' && path[0] <= 'z') || (path[0] >= 'A' && path[0] <= 'Z'))) {
+        return path.size() >= 3 && is_separator(path[2]) ? 3 : 2;
+    }
+    return !path.empty() && is_separator(path[0]) ? 1 : 0;
+}
 
-    // Copy the directory part into the new string
-    std::strncpy(directory.str, path, directoryLength);
-    directory.str[directoryLength] = '\0';  // Null-terminate the string
+New_String ST_API get_directory(str_ptr_t path) {
+    const std::string_view directory = path_directory(path);
 
-    return directory;
+    New_String result(directory.size());
+    if (!directory.empty()) memcpy(result.str, directory.data(), directory.size());
+    result.str[directory.size()] = '\0';
+    return result;
 }
 
 New_String ST_API get_exe_dir() {
-    return get_directory(get_exe_path().str).str;
+    return New_String(get_cached_exe_dir());
+}
+
+str_ptr_t ST_API get_cached_exe_dir() {
+    static const New_String exe_dir = get_directory(get_exe_path().str);
+    return exe_dir.str;
+}
+
+bool ST_API is_absolute_path(std::string_view path) {
+    return root_length(path) > 0;
+}
+
+std::string_view ST_API path_directory(std::string_view path) {
+    const size_t separator = find_last_separator(path);
+    return separator == std::string_view::npos ? std::string_view() : path.substr(0, separator);
+}
+
+std::string_view ST_API path_filename(std::string_view path) {
+    const size_t separator = find_last_separator(path);
+    return separator == std::string_view::npos ? path : path.substr(separator + 1);
+}
+
+std::string_view ST_API path_extension(std::string_view path) {
+    const std::string_view filename = path_filename(path);
+    const size_t dot = filename.rfind('.');
+
+    // ".gitignore" is a name, not an extension
+    return dot == std::string_view::npos || dot == 0 ? std::string_view() : filename.substr(dot);
+}
+
+std::string_view ST_API path_stem(std::string_view path) {
+    const std::string_view filename = path_filename(path);
+    return filename.substr(0, filename.size() - path_extension(filename).size());
+}
+
+bool ST_API path_join(path_str_t out, std::string_view a, std::string_view b) {
+    if (a.empty() || is_absolute_path(b)) a = std::string_view();
+
+    const bool needs_separator = !a.empty() && !b.empty() && !is_separator(a.back());
+    const size_t len = a.size() + needs_separator + b.size();
+    if (len >= sizeof(path_str_t)) return false;
+
+    if (!a.empty()) memmove(out, a.data(), a.size());
+    if (needs_separator) out[a.size()] = '/';
+    if (!b.empty()) memmove(out + a.size() + needs_separator, b.data(), b.size());
+    out[len] = '\0';
+    return true;
+}
+
+bool ST_API path_normalize(path_str_t out, str_ptr_t path) {
+    const size_t path_length = strlen(path);
+    if (path_length >= sizeof(path_str_t)) return false;
+
+    // Output never gets ahead of input, so writing over path as we go is fine
+    const size_t root = root_length(path);
+    size_t len = 0;
+    for (; len < root; len++) out[len] = is_separator(path[len]) ? '/' : path[len];
+
+    // Leading ".." segments of relative paths can't be resolved and are kept
+    size_t kept_parents = 0;
+
+    size_t i = root;
+    while (i < path_length) {
+        size_t end = i;
+        while (end < path_length && !is_separator(path[end])) end++;
+        const size_t segment_length = end - i;
+
+        if (segment_length == 0 || (segment_length == 1 && path[i] == '.')) {
+            // Skip
+        } else if (segment_length == 2 && path[i] == '.' && path[i + 1] == '.') {
+            if (len > root + (kept_parents ? kept_parents * 3 - 1 : 0)) {
+                while (len > root && out[len - 1] != '/') len--;
+                if (len > root) len--;
+            } else if (root == 0) {
+                if (len > 0) out[len++] = '/';
+                out[len++] = '.';
+                out[len++] = '.';
+                kept_parents++;
+            }
+        } else {
+            if (len > root) out[len++] = '/';
+            memmove(out + len, path + i, segment_length);
+            len += segment_length;
+        }
+        i = end + 1;
+    }
+
+    if (len == 0) out[len++] = '.';
+    out[len] = '\0';
+    return true;
+}
+
+bool ST_API path_relative(path_str_t out, str_ptr_t path, str_ptr_t base) {
+    path_str_t normalized_path;
+    path_str_t normalized_base;
+    if (!path_normalize(normalized_path, path) || !path_normalize(normalized_base, base)) return false;
+
+    std::string_view rest = normalized_path;
+    std::string_view base_rest = normalized_base;
+
+    // Both relative, or absolute with the same root ("/", "C:/")
+    const size_t root = root_length(rest);
+    if (root != root_length(base_rest) || rest.substr(0, root) != base_rest.substr(0, root)) return false;
+    rest.remove_prefix(root);
+    base_rest.remove_prefix(root);
+
+    if (rest.empty() || rest == ".") rest = std::string_view();
+    if (base_rest.empty() || base_rest == ".") base_rest = std::string_view();
+
+    // Strip the segments both share
+    while (!rest.empty() && !base_rest.empty()) {
+        const size_t rest_end = std::min(rest.find('/'), rest.size());
+        const size_t base_end = std::min(base_rest.find('/'), base_rest.size());
+        if (rest.substr(0, rest_end) != base_rest.substr(0, base_end)) break;
+
+        rest.remove_prefix(rest_end);
+        base_rest.remove_prefix(base_end);
+        if (!rest.empty()) rest.remove_prefix(1);
+        if (!base_rest.empty()) base_rest.remove_prefix(1);
+    }
+
+    size_t len = 0;
+    while (!base_rest.empty()) {
+        const size_t base_end = std::min(base_rest.find('/'), base_rest.size());
+        // The name a ".." of the base leaves is unknown
+        if (base_rest.substr(0, base_end) == "..") return false;
+        if (len + 3 >= sizeof(path_str_t)) return false;
+        memcpy(out + len, "../", 3);
+        len += 3;
+
+        base_rest.remove_prefix(base_end);
+        if (!base_rest.empty()) base_rest.remove_prefix(1);
+    }
+
+    if (len + rest.size() >= sizeof(path_str_t)) return false;
+    if (!rest.empty()) memcpy(out + len, rest.data(), rest.size());
+    len += rest.size();
+
+    // Drop the trailing separator of "../", an empty result means the same directory
+    if (len > 0 && out[len - 1] == '/') len--;
+    if (len == 0) out[len++] = '.';
+    out[len] = '\0';
+    return true;
 }
 
 NS_END(io)
-NS_END(os)
\ No newline at end of file
+NS_END(os)
@@ -0,0 +1,256 @@
+#include "pch.h"
+
+#include "os/async_io.h"
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <atomic>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+// io_uring through raw syscalls, the rings are shared with the kernel through mmap
+
+struct _Async_Kernel_Queue {
+    int fd;
+
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    io_uring_sqe* sqes;
+    size_t sqes_size;
+
+    u32* sq_head;
+    u32* sq_tail;
+    u32 sq_mask;
+    u32 sq_entries;
+    u32* sq_array;
+
+    u32* cq_head;
+    u32* cq_tail;
+    u32 cq_mask;
+    io_uring_cqe* cqes;
+
+    u32 to_submit;
+};
+
+static int io_uring_setup(u32 entries, io_uring_params* params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int io_uring_enter(int fd, u32 to_submit, u32 min_complete, u32 flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int io_uring_register(int fd, u32 opcode, void* arg, u32 nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static u32 load_acquire(u32* value) {
+    return std::atomic_ref<u32>(*value).load(std::memory_order_acquire);
+}
+
+static void store_release(u32* value, u32 new_value) {
+    std::atomic_ref<u32>(*value).store(new_value, std::memory_order_release);
+}
+
+static Io_Status errno_to_status(int error) {
+    switch (error) {
+        case ECANCELED:
+            return IO_STATUS_CANCELLED;
+        case EACCES:
+        case EPERM:
+        case EBADF:
+            return IO_STATUS_ACCESS_DENIED;
+        case EINVAL:
+        case EFAULT:
+            return IO_STATUS_INVALID_ARGUMENT;
+        case ENOMEM:
+            return IO_STATUS_OUT_OF_MEMORY;
+        default:
+            return IO_STATUS_UNKNOWN_ERROR;
+    }
+}
+
+static bool supports_ops(int fd) {
+    const u32 op_count = 256;
+    auto probe = (io_uring_probe*)calloc(1, sizeof(io_uring_probe) + op_count * sizeof(io_uring_probe_op));
+    if (!probe) return false;
+
+    bool supported = false;
+    if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, op_count) == 0) {
+        const u8 required[] = { IORING_OP_READ, IORING_OP_WRITE, IORING_OP_ASYNC_CANCEL };
+        supported = true;
+        for (u8 op : required) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) supported = false;
+        }
+    }
+    free(probe);
+    return supported;
+}
+
+static void unmap_rings(_Async_Kernel_Queue* queue) {
+    if (queue->sqes && queue->sqes != MAP_FAILED) munmap(queue->sqes, queue->sqes_size);
+    if (queue->cq_ring && queue->cq_ring != MAP_FAILED && queue->cq_ring != queue->sq_ring) munmap(queue->cq_ring, queue->cq_ring_size);
+    if (queue->sq_ring && queue->sq_ring != MAP_FAILED) munmap(queue->sq_ring, queue->sq_ring_size);
+}
+
+_Async_Kernel_Queue* _async_kernel_queue_create(u32 queue_depth) {
+    io_uring_params params = {};
+    params.flags = IORING_SETUP_CLAMP;
+
+    // Fails on kernels before 5.1, or where io_uring is disabled (io_uring_disabled, seccomp)
+    const int fd = io_uring_setup(queue_depth, &params);
+    if (fd < 0) return NULL;
+
+    if (!supports_ops(fd)) {
+        close(fd);
+        return NULL;
+    }
+
+    auto queue = (_Async_Kernel_Queue*)calloc(1, sizeof(_Async_Kernel_Queue));
+    if (!queue) {
+        close(fd);
+        return NULL;
+    }
+    queue->fd = fd;
+
+    queue->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+    queue->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) queue->sq_ring_size = queue->cq_ring_size = std::max(queue->sq_ring_size, queue->cq_ring_size);
+
+    queue->sq_ring = mmap(NULL, queue->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    queue->cq_ring = single_mmap ? queue->sq_ring
+        : mmap(NULL, queue->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    queue->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    queue->sqes = (io_uring_sqe*)mmap(NULL, queue->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if (queue->sq_ring == MAP_FAILED || queue->cq_ring == MAP_FAILED || queue->sqes == MAP_FAILED) {
+        unmap_rings(queue);
+        close(fd);
+        free(queue);
+        return NULL;
+    }
+
+    byte_t* sq = (byte_t*)queue->sq_ring;
+    queue->sq_head = (u32*)(sq + params.sq_off.head);
+    queue->sq_tail = (u32*)(sq + params.sq_off.tail);
+    queue->sq_mask = *(u32*)(sq + params.sq_off.ring_mask);
+    queue->sq_entries = *(u32*)(sq + params.sq_off.ring_entries);
+    queue->sq_array = (u32*)(sq + params.sq_off.array);
+
+    byte_t* cq = (byte_t*)queue->cq_ring;
+    queue->cq_head = (u32*)(cq + params.cq_off.head);
+    queue->cq_tail = (u32*)(cq + params.cq_off.tail);
+    queue->cq_mask = *(u32*)(cq + params.cq_off.ring_mask);
+    queue->cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    return queue;
+}
+
+void _async_kernel_queue_destroy(_Async_Kernel_Queue* queue) {
+    unmap_rings(queue);
+    close(queue->fd);
+    free(queue);
+}
+
+static io_uring_sqe* get_sqe(_Async_Kernel_Queue* queue) {
+    // Only this thread moves the tail, the kernel moves the head
+    const u32 tail = *queue->sq_tail;
+    if (tail - load_acquire(queue->sq_head) >= queue->sq_entries) return NULL;
+
+    const u32 index = tail & queue->sq_mask;
+    io_uring_sqe* sqe = &queue->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    queue->sq_array[index] = index;
+    return sqe;
+}
+
+static void commit_sqe(_Async_Kernel_Queue* queue) {
+    store_release(queue->sq_tail, *queue->sq_tail + 1);
+    queue->to_submit++;
+}
+
+bool _async_kernel_queue_push(_Async_Kernel_Queue* queue, Async_Request* request) {
+    io_uring_sqe* sqe = get_sqe(queue);
+    if (!sqe) return false;
+
+    sqe->opcode = request->op == ASYNC_OP_READ ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe->fd = (int)(intptr_t)request->file->__os_handle;
+    const u64 done = (u64)request->bytes;
+    const u64 remaining = request->size - done;
+    sqe->addr = (u64)(uintptr_t)request->buffer + done;
+    sqe->len = (u32)(remaining < _ASYNC_KERNEL_MAX_TRANSFER ? remaining : _ASYNC_KERNEL_MAX_TRANSFER);
+    sqe->off = request->offset + done;
+    sqe->user_data = (u64)(uintptr_t)request;
+
+    commit_sqe(queue);
+    return true;
+}
+
+bool _async_kernel_queue_push_cancel(_Async_Kernel_Queue* queue, Async_Request* request) {
+    io_uring_sqe* sqe = get_sqe(queue);
+    if (!sqe) return false;
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = (u64)(uintptr_t)request;
+
+    // The cancel completion itself carries no request
+    sqe->user_data = 0;
+
+    commit_sqe(queue);
+    return true;
+}
+
+u32 _async_kernel_queue_submit(_Async_Kernel_Queue* queue) {
+    u32 submitted = 0;
+    while (queue->to_submit > 0) {
+        const int result = io_uring_enter(queue->fd, queue->to_submit, 0, 0);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            // EAGAIN/EBUSY: the completion ring is backed up, retry after the next reap
+            break;
+        }
+        queue->to_submit -= (u32)result;
+        submitted += (u32)result;
+    }
+    return submitted;
+}
+
+u32 _async_kernel_queue_reap(_Async_Kernel_Queue* queue, bool wait, void (*complete)(Async_Request* request, s64 bytes, Io_Status status, void* context), void* context) {
+    u32 reaped = 0;
+    while (true) {
+        u32 head = *queue->cq_head;
+        const u32 tail = load_acquire(queue->cq_tail);
+
+        for (; head != tail; head++) {
+            const io_uring_cqe& cqe = queue->cqes[head & queue->cq_mask];
+            if (!cqe.user_data) continue;
+
+            const Io_Status status = cqe.res < 0 ? errno_to_status(-cqe.res) : IO_STATUS_OK;
+            complete((Async_Request*)(uintptr_t)cqe.user_data, cqe.res < 0 ? 0 : cqe.res, status, context);
+            reaped++;
+        }
+        store_release(queue->cq_head, head);
+
+        if (reaped > 0 || !wait) break;
+
+        // Also flushes anything left unsubmitted
+        const int submitted = io_uring_enter(queue->fd, queue->to_submit, 1, IORING_ENTER_GETEVENTS);
+        if (submitted >= 0) queue->to_submit -= (u32)submitted;
+        else if (errno != EINTR) break;
+    }
+
+    if (queue->to_submit > 0) _async_kernel_queue_submit(queue);
+    return reaped;
+}
+
+NS_END(io)
+NS_END(os)
@@ -0,0 +1,96 @@
+#include "pch.h"
+
+#include "os/crash.h"
+
+#include "logger.h"
+
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <execinfo.h>
+
+#define MAX_BACKTRACE_DEPTH 64
+
+NS_BEGIN(os)
+
+path_str_t crash_log_path = "";
+
+// Big enough to run the handler after a stack overflow
+byte_t crash_stack[64 * 1024];
+
+// Only async-signal-safe calls from here on
+
+static void write_str(int fd, str_ptr_t str) {
+    if (write(fd, str, strlen(str)) < 0) return;
+}
+
+static str_ptr_t signal_name(int sig) {
+    switch (sig) {
+        case SIGSEGV: return "SIGSEGV";
+        case SIGABRT: return "SIGABRT";
+        case SIGILL:  return "SIGILL";
+        case SIGTRAP: return "SIGTRAP";
+        case SIGBUS:  return "SIGBUS";
+        case SIGFPE:  return "SIGFPE";
+        default:      return "Unknown signal";
+    }
+}
+
+static void write_crash_report(int fd, int sig, void** frames, int frame_count) {
+    write_str(fd, "\n======================================================================================================\n");
+    write_str(fd, "Fatal signal ");
+    write_str(fd, signal_name(sig));
+    write_str(fd, ", last log messages:\n");
+    write_str(fd, "======================================================================================================\n");
+    dump_log_ring(fd);
+    write_str(fd, "======================================================================================================\n");
+    write_str(fd, "Backtrace:\n");
+    backtrace_symbols_fd(frames, frame_count, fd);
+}
+
+static void crash_handler(int sig, siginfo_t*, void*) {
+    void* frames[MAX_BACKTRACE_DEPTH];
+    const int frame_count = backtrace(frames, MAX_BACKTRACE_DEPTH);
+
+    write_crash_report(STDERR_FILENO, sig, frames, frame_count);
+
+    if (crash_log_path[0]) {
+        const int fd = open(crash_log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            write_crash_report(fd, sig, frames, frame_count);
+            fsync(fd);
+            close(fd);
+        }
+    }
+
+    // SA_RESETHAND restored the default action, so this terminates with the original signal
+    raise(sig);
+}
+
+void install_crash_handlers(str_ptr_t log_path) {
+    if (log_path) {
+        strncpy(crash_log_path, log_path, sizeof(crash_log_path) - 1);
+    }
+
+    // The first backtrace() call loads libgcc which allocates, so do it now rather than in the handler
+    void* warmup[1];
+    backtrace(warmup, 1);
+
+    stack_t alt_stack = {};
+    alt_stack.ss_sp = crash_stack;
+    alt_stack.ss_size = sizeof(crash_stack);
+    sigaltstack(&alt_stack, NULL);
+
+    struct sigaction action = {};
+    action.sa_sigaction = crash_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESETHAND | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+
+    // __builtin_trap() raises SIGILL on x86 and SIGTRAP on some other targets
+    const int signals[] = { SIGSEGV, SIGABRT, SIGILL, SIGTRAP, SIGBUS, SIGFPE };
+    for (int sig : signals) {
+        sigaction(sig, &action, NULL);
+    }
+}
+
+NS_END(os)
@@ -0,0 +1,92 @@
+#include "pch.h"
+
+#include "os/directory_scanner.h"
+
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+// Not exposed by glibc before 2.30
+struct linux_dirent64 {
+    u64 d_ino;
+    s64 d_off;
+    u16 d_reclen;
+    u8 d_type;
+    char d_name[1];
+};
+
+void* _dir_scan_open_root(str_ptr_t root) {
+    const int fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    return new int(fd);
+}
+
+void _dir_scan_close_root(void* root) {
+    close(*(int*)root);
+    delete (int*)root;
+}
+
+bool _dir_scan_read(void* root, str_ptr_t root_path, str_ptr_t relative, u32 flags, _dir_emit_fn_t emit, void* context) {
+    (void)root_path;
+
+    // Always a fresh descriptor, getdents64 advances the offset of the one it reads
+    const int fd = openat(*(int*)root, relative[0] ? relative : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) return false;
+
+    alignas(linux_dirent64) char buffer[32 * 1024];
+    bool ok = true;
+    while (true) {
+        const long read = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+        if (read == 0) break;
+        if (read < 0) {
+            ok = false;
+            break;
+        }
+
+        for (long offset = 0; offset < read;) {
+            auto entry = (linux_dirent64*)(buffer + offset);
+            offset += entry->d_reclen;
+
+            str_ptr_t name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            Dir_Entry_Type type;
+            switch (entry->d_type) {
+                case DT_REG: type = DIR_ENTRY_FILE;      break;
+                case DT_DIR: type = DIR_ENTRY_DIRECTORY; break;
+                case DT_LNK: type = DIR_ENTRY_SYMLINK;   break;
+                default:     type = DIR_ENTRY_OTHER;     break;
+            }
+
+            u64 size = 0, modified_ns = 0;
+            // Some filesystems don't report the type, the stat is needed for it anyway
+            if ((flags & DIR_SCAN_STAT) || entry->d_type == DT_UNKNOWN) {
+                struct stat st;
+                if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                    if (S_ISREG(st.st_mode))      type = DIR_ENTRY_FILE;
+                    else if (S_ISDIR(st.st_mode)) type = DIR_ENTRY_DIRECTORY;
+                    else if (S_ISLNK(st.st_mode)) type = DIR_ENTRY_SYMLINK;
+                    else                          type = DIR_ENTRY_OTHER;
+
+                    if (flags & DIR_SCAN_STAT) {
+                        size = (u64)st.st_size;
+                        modified_ns = (u64)st.st_mtim.tv_sec * 1000000000ull + (u64)st.st_mtim.tv_nsec;
+                    }
+                }
+            }
+
+            emit(context, name, strlen(name), type, size, modified_ns);
+        }
+    }
+
+    close(fd);
+    return ok;
+}
+
+NS_END(io)
+NS_END(os)
@@ -0,0 +1,159 @@
+#include "pch.h"
+
+#include "os/file_watcher.h"
+
+#include "logger.h"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+
+#include <filesystem>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+#define WATCH_MASK (IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+
+struct _File_Watch_Queue {
+    int fd;
+
+    // inotify watches single directories, recursive watches add one per subdirectory
+    struct Watch {
+        Dynamic_String directory;
+        bool recursive;
+    };
+    Hash_Map<int, Watch> watches;
+};
+
+_File_Watch_Queue* _file_watch_queue_create() {
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        log_error("Could not create inotify instance: {}", strerror(errno));
+        return NULL;
+    }
+
+    auto queue = new _File_Watch_Queue();
+    queue->fd = fd;
+    return queue;
+}
+
+void _file_watch_queue_destroy(_File_Watch_Queue* queue) {
+    close(queue->fd);
+    delete queue;
+}
+
+static bool add_watch(_File_Watch_Queue* queue, const Dynamic_String& directory, bool recursive) {
+    const int wd = inotify_add_watch(queue->fd, directory.c_str(), WATCH_MASK | IN_ONLYDIR);
+    if (wd < 0) {
+        // ENOSPC means fs.inotify.max_user_watches is exhausted
+        log_error("Could not watch '{}': {}", directory, strerror(errno));
+        return false;
+    }
+    queue->watches[wd] = { directory, recursive };
+    return true;
+}
+
+static bool add_watch_tree(_File_Watch_Queue* queue, const Dynamic_String& directory, bool recursive) {
+    if (!add_watch(queue, directory, recursive)) return false;
+    if (!recursive) return true;
+
+    bool ok = true;
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (it->is_directory(error) && !it->is_symlink(error)) ok &= add_watch(queue, it->path().generic_string(), true);
+    }
+    return ok && !error;
+}
+
+// Watches follow the directory's inode, drops the ones whose path went stale when it moved
+static void remove_watch_tree(_File_Watch_Queue* queue, const Dynamic_String& directory) {
+    for (auto it = queue->watches.begin(); it != queue->watches.end();) {
+        const Dynamic_String& watched = it->second.directory;
+        const bool inside = watched.size() >= directory.size() && watched.compare(0, directory.size(), directory) == 0 &&
+            (watched.size() == directory.size() || watched[directory.size()] == '/');
+        if (!inside) {
+            ++it;
+            continue;
+        }
+        inotify_rm_watch(queue->fd, it->first);
+        it = queue->watches.erase(it);
+    }
+}
+
+bool _file_watch_queue_add(_File_Watch_Queue* queue, str_ptr_t directory, bool recursive) {
+    Dynamic_String path = directory;
+    while (path.size() > 1 && path.back() == '/') path.pop_back();
+    return add_watch_tree(queue, path, recursive);
+}
+
+void _file_watch_queue_read(_File_Watch_Queue* queue, void (*emit)(str_ptr_t path, u32 changes, void* context), void* context) {
+    alignas(inotify_event) char buffer[64 * (sizeof(inotify_event) + NAME_MAX + 1)];
+
+    while (true) {
+        const ssize_t len = read(queue->fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            if (len < 0 && errno == EINTR) continue;
+            return;
+        }
+
+        for (ssize_t offset = 0; offset < len;) {
+            const inotify_event* event = (const inotify_event*)(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                log_warn("File watcher queue overflowed, some changes were lost");
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                queue->watches.erase(event->wd);
+                continue;
+            }
+
+            const auto watch = queue->watches.find(event->wd);
+            if (watch == queue->watches.end()) continue;
+
+            if (event->mask & IN_DELETE_SELF) {
+                queue->watches.erase(watch);
+                continue;
+            }
+            if (event->mask & IN_MOVE_SELF) {
+                // Moves below a recursive watch are handled by the parent's IN_MOVED_FROM, this is
+                // a watched root that moved away
+                log_warn("'{}' was moved, it's no longer watched", watch->second.directory);
+                const Dynamic_String directory = watch->second.directory;
+                remove_watch_tree(queue, directory);
+                continue;
+            }
+            if (event->len == 0) continue;
+
+            const Dynamic_String path = watch->second.directory + "/" + event->name;
+            const bool recursive = watch->second.recursive;
+
+            if (event->mask & IN_ISDIR) {
+                // A renamed directory is watched again under its new path by IN_MOVED_TO
+                if (event->mask & IN_MOVED_FROM) remove_watch_tree(queue, path);
+
+                // New directories under a recursive watch get watched too, along with anything
+                // created in them before the watch was added
+                if (recursive && (event->mask & (IN_CREATE | IN_MOVED_TO)) && add_watch_tree(queue, path, true)) {
+                    std::error_code error;
+                    for (auto it = std::filesystem::recursive_directory_iterator(path, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+                        if (it->is_regular_file(error)) emit(it->path().generic_string().c_str(), FILE_CHANGE_CREATED, context);
+                    }
+                }
+                continue;
+            }
+
+            u32 changes = 0;
+            if (event->mask & (IN_CLOSE_WRITE | IN_MODIFY)) changes |= FILE_CHANGE_MODIFIED;
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) changes |= FILE_CHANGE_CREATED;
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM)) changes |= FILE_CHANGE_DELETED;
+            if (changes) emit(path.c_str(), changes, context);
+        }
+    }
+}
+
+NS_END(io)
+NS_END(os)
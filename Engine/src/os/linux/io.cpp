@@ -0,0 +1,214 @@
+#include "pch.h"
+
+#include "os/io.h"
+
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+static Io_Status errno_to_status(int error) {
+    switch (error) {
+        case ENOENT:
+        case ENOTDIR:
+            return IO_STATUS_FILE_NOT_FOUND;
+        case EACCES:
+        case EPERM:
+        case EROFS:
+            return IO_STATUS_ACCESS_DENIED;
+        case EEXIST:
+            return IO_STATUS_ALREADY_EXISTS;
+        case EINVAL:
+        case EISDIR:
+            return IO_STATUS_INVALID_ARGUMENT;
+        case ENOMEM:
+            return IO_STATUS_OUT_OF_MEMORY;
+        default:
+            return IO_STATUS_UNKNOWN_ERROR;
+    }
+}
+
+static int flags_to_advice(u32 flags) {
+    if (flags & MAPPING_FLAG_SEQUENTIAL) return MADV_SEQUENTIAL;
+    if (flags & MAPPING_FLAG_RANDOM) return MADV_RANDOM;
+    return MADV_NORMAL;
+}
+
+File::File(str_ptr_t path, File_Access access, u32 flags) : access(access) {
+    int open_flags = O_CLOEXEC;
+    switch (access) {
+        case FILE_ACCESS_READ:       open_flags |= O_RDONLY; break;
+        case FILE_ACCESS_WRITE:      open_flags |= O_WRONLY; break;
+        case FILE_ACCESS_READ_WRITE: open_flags |= O_RDWR;   break;
+    }
+    if (flags & FILE_FLAG_CREATE) open_flags |= O_CREAT;
+    if (flags & FILE_FLAG_TRUNCATE) open_flags |= O_TRUNC;
+    if (flags & FILE_FLAG_EXCLUSIVE) open_flags |= O_EXCL;
+
+    const int fd = open(path, open_flags, 0644);
+    if (fd < 0) {
+        _status = errno_to_status(errno);
+        return;
+    }
+
+    __os_handle = (void*)(intptr_t)fd;
+    _status = IO_STATUS_OK;
+}
+
+File::~File() {
+    if (_status == IO_STATUS_OK) close((int)(intptr_t)__os_handle);
+}
+
+s64 File::read_at(void* buffer, size_t size, u64 offset) const {
+    if (_status != IO_STATUS_OK) return -1;
+
+    const int fd = (int)(intptr_t)__os_handle;
+    size_t total = 0;
+    while (total < size) {
+        const ssize_t n = pread(fd, (byte_t*)buffer + total, size - total, (off_t)(offset + total));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) break;
+        total += (size_t)n;
+    }
+    return (s64)total;
+}
+
+s64 File::write_at(const void* buffer, size_t size, u64 offset) const {
+    if (_status != IO_STATUS_OK) return -1;
+
+    const int fd = (int)(intptr_t)__os_handle;
+    size_t total = 0;
+    while (total < size) {
+        const ssize_t n = pwrite(fd, (const byte_t*)buffer + total, size - total, (off_t)(offset + total));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        total += (size_t)n;
+    }
+    return (s64)total;
+}
+
+u64 File::get_size() const {
+    struct stat st;
+    if (_status != IO_STATUS_OK || fstat((int)(intptr_t)__os_handle, &st) != 0) return 0;
+    return (u64)st.st_size;
+}
+
+bool File::sync() const {
+    if (_status != IO_STATUS_OK) return false;
+    // Metadata other than the size isn't needed to read the data back
+    return fdatasync((int)(intptr_t)__os_handle) == 0;
+}
+
+bool File::preallocate(u64 size) const {
+    if (_status != IO_STATUS_OK || size == 0) return false;
+    return fallocate((int)(intptr_t)__os_handle, FALLOC_FL_KEEP_SIZE, 0, (off_t)size) == 0;
+}
+
+Mapped_File::Mapped_File(str_ptr_t path, Mapping_Access access, u32 flags) : access(access) {
+    const bool writable = access == MAPPING_ACCESS_READ_WRITE;
+
+    const int fd = open(path, (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0) {
+        _status = errno_to_status(errno);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        _status = errno_to_status(errno);
+        close(fd);
+        return;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        _status = IO_STATUS_INVALID_ARGUMENT;
+        close(fd);
+        return;
+    }
+
+    size = (size_t)st.st_size;
+    if (size == 0) {
+        close(fd);
+        _status = IO_STATUS_OK;
+        return;
+    }
+
+    const int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+    const int map_flags = MAP_SHARED | ((flags & MAPPING_FLAG_PREFAULT) ? MAP_POPULATE : 0);
+
+    void* mapping = mmap(NULL, size, prot, map_flags, fd, 0);
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        _status = errno_to_status(errno);
+        size = 0;
+        return;
+    }
+
+    data = (byte_t*)mapping;
+    _status = IO_STATUS_OK;
+
+    if (flags & (MAPPING_FLAG_SEQUENTIAL | MAPPING_FLAG_RANDOM)) advise(flags);
+}
+
+Mapped_File::~Mapped_File() {
+    if (data) munmap(data, size);
+}
+
+void Mapped_File::advise(u32 flags, size_t offset, size_t range_size) {
+    if (!data || offset >= size) return;
+
+    // madvise wants a page aligned start
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t aligned_offset = offset & ~(page_size - 1);
+    const size_t end = range_size == 0 || range_size > size - offset ? size : offset + range_size;
+
+    madvise(data + aligned_offset, end - aligned_offset, flags_to_advice(flags));
+    if (flags & MAPPING_FLAG_PREFAULT) madvise(data + aligned_offset, end - aligned_offset, MADV_WILLNEED);
+}
+
+bool Mapped_File::flush() {
+    if (_status != IO_STATUS_OK) return false;
+    if (!data || access != MAPPING_ACCESS_READ_WRITE) return true;
+    return msync(data, size, MS_SYNC) == 0;
+}
+
+bool ST_API replace_file(str_ptr_t from, str_ptr_t to) {
+    if (rename(from, to) != 0) return false;
+
+    // The rename itself only survives a crash once the directory entry is synced
+    path_str_t directory;
+    const std::string_view parent = path_directory(to);
+    if (parent.empty()) snprintf(directory, sizeof(directory), ".");
+    else snprintf(directory, sizeof(directory), "%.*s", (int)parent.size(), parent.data());
+
+    const int fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+bool ST_API remove_file(str_ptr_t path) {
+    return unlink(path) == 0;
+}
+
+New_String ST_API get_exe_path() {
+    New_String result(sizeof(path_str_t));
+    const ssize_t len = readlink("/proc/self/exe", result.str, sizeof(path_str_t));
+    result.str[len > 0 ? len : 0] = '\0';
+    return result;
+}
+
+NS_END(io)
+NS_END(os)
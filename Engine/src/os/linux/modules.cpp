@@ -15,22 +15,25 @@ Module::Module(const char* path) {
         this->init = (init_fn_t) dlsym(linux_handle, "init");
         this->update = (update_fn_t) dlsym(linux_handle, "update");
 
-        _os_handle = linux_handle;
+        __os_handle = linux_handle;
+        _status = MODULE_STATUS_OK;
         
         if (!this->init || !this->update) {
             // Function not found, unload shared library
             dlclose(linux_handle);
-            _os_handle = nullptr;
+            __os_handle = nullptr;
+            _status = MODULE_STATUS_INVALID_FORMAT;
         }
     } else {
-        _os_handle = nullptr;
+        __os_handle = nullptr;
+        _status = MODULE_STATUS_FILE_NOT_FOUND;
     }
 }
 
 Module::~Module() {
     // Unload the shared library
-    if (_os_handle) {
-        dlclose(_os_handle);
+    if (__os_handle) {
+        dlclose(__os_handle);
     }
 }
 
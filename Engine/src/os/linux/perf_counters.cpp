@@ -0,0 +1,73 @@
+#include "pch.h"
+
+#include "os/perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+NS_BEGIN(os)
+
+// Order matches the layout of Perf_Counter_Values, the first one leads the group
+const u64 perf_counter_configs[] = {
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+#define PERF_COUNTER_COUNT (sizeof(perf_counter_configs) / sizeof(perf_counter_configs[0]))
+
+static_assert(sizeof(Perf_Counter_Values) == PERF_COUNTER_COUNT * sizeof(u64));
+
+thread_local int perf_counter_fds[PERF_COUNTER_COUNT] = { -1, -1, -1, -1 };
+
+static int perf_event_open(perf_event_attr* attr, int group_fd) {
+    return (int)syscall(SYS_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+bool open_thread_perf_counters() {
+    if (perf_counter_fds[0] >= 0) return true;
+
+    for (size_t i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = perf_counter_configs[i];
+        attr.disabled = i == 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        perf_counter_fds[i] = perf_event_open(&attr, i == 0 ? -1 : perf_counter_fds[0]);
+        if (perf_counter_fds[i] < 0) {
+            close_thread_perf_counters();
+            return false;
+        }
+    }
+
+    ioctl(perf_counter_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(perf_counter_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void close_thread_perf_counters() {
+    for (auto& fd : perf_counter_fds) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+}
+
+bool read_thread_perf_counters(Perf_Counter_Values* values) {
+    if (perf_counter_fds[0] < 0) return false;
+
+    // One read returns the whole group: { nr, value[nr] }
+    u64 group[1 + PERF_COUNTER_COUNT];
+    if (read(perf_counter_fds[0], group, sizeof(group)) != (ssize_t)sizeof(group)) return false;
+
+    memcpy(values, &group[1], sizeof(*values));
+    return true;
+}
+
+NS_END(os)
@@ -0,0 +1,277 @@
+#include "pch.h"
+
+#include "os/sampler.h"
+
+#include "logger.h"
+
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <cxxabi.h>
+#include <sys/syscall.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+NS_BEGIN(os)
+
+struct Sampler_Thread {
+    name_str_t name;
+    bool used;
+    timer_t timer;
+    uintptr_t stack_lo;
+    uintptr_t stack_hi;
+};
+
+struct Sampler_Sample {
+    std::atomic<u32> ready;
+    u32 thread;
+    u32 depth;
+    void* frames[SAMPLER_MAX_DEPTH];
+};
+
+Sampler_Thread sampler_threads[MAX_SAMPLER_THREADS];
+std::mutex sampler_mutex;
+
+// Read from the signal handler, initial-exec so the access can't allocate
+thread_local __attribute__((tls_model("initial-exec"))) s32 sampler_thread_index = -1;
+
+Sampler_Sample* sampler_samples = NULL;
+u32 sampler_capacity = 0;
+u32 sampler_interval_ns = 0;
+std::atomic<bool> sampler_running = false;
+std::atomic<u32> sampler_write_index = 0;
+std::atomic<u64> sampler_dropped = 0;
+
+bool sampler_handler_installed = false;
+
+// Only async-signal-safe code in the handler
+
+static void sampler_handler(int, siginfo_t*, void* context) {
+    const s32 thread_index = sampler_thread_index;
+    if (thread_index < 0 || !sampler_running.load(std::memory_order_acquire)) return;
+
+    const u32 slot = sampler_write_index.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= sampler_capacity) {
+        sampler_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const auto& thread = sampler_threads[thread_index];
+    const auto uc = (const ucontext_t*)context;
+
+#if defined(__x86_64__)
+    const uintptr_t pc = (uintptr_t)uc->uc_mcontext.gregs[REG_RIP];
+    uintptr_t fp = (uintptr_t)uc->uc_mcontext.gregs[REG_RBP];
+#elif defined(__aarch64__)
+    const uintptr_t pc = (uintptr_t)uc->uc_mcontext.pc;
+    uintptr_t fp = (uintptr_t)uc->uc_mcontext.regs[29];
+#else
+#error "Sampler needs the program counter and frame pointer registers for this architecture"
+#endif
+
+    auto& sample = sampler_samples[slot];
+    u32 depth = 0;
+    sample.frames[depth++] = (void*)pc;
+
+    // Each frame starts with the caller's frame pointer followed by the return address. Stay
+    // within the thread's stack so a frame without a frame pointer can't make us fault.
+    while (depth < SAMPLER_MAX_DEPTH && fp >= thread.stack_lo && fp + 2 * sizeof(uintptr_t) <= thread.stack_hi && (fp & (sizeof(uintptr_t) - 1)) == 0) {
+        const uintptr_t* frame = (const uintptr_t*)fp;
+        const uintptr_t next_fp = frame[0];
+        const uintptr_t return_address = frame[1];
+        if (!return_address) break;
+
+        sample.frames[depth++] = (void*)return_address;
+        if (next_fp <= fp) break;
+        fp = next_fp;
+    }
+
+    sample.thread = (u32)thread_index;
+    sample.depth = depth;
+    sample.ready.store(1, std::memory_order_release);
+}
+
+static void arm_timer(timer_t timer, u32 interval_ns) {
+    itimerspec spec = {};
+    spec.it_interval.tv_sec = interval_ns / 1000000000;
+    spec.it_interval.tv_nsec = interval_ns % 1000000000;
+    spec.it_value = spec.it_interval;
+    timer_settime(timer, 0, &spec, NULL);
+}
+
+bool sampler_register_thread(str_ptr_t name) {
+    std::lock_guard<std::mutex> lock(sampler_mutex);
+    if (sampler_thread_index >= 0) return true;
+
+    s32 index = -1;
+    for (s32 i = 0; i < MAX_SAMPLER_THREADS; i++) {
+        if (!sampler_threads[i].used) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        log_error("Could not register thread '{}' for sampling, all {} slots are in use", name, MAX_SAMPLER_THREADS);
+        return false;
+    }
+
+    auto& thread = sampler_threads[index];
+
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) return false;
+    void* stack_addr = NULL;
+    size_t stack_size = 0;
+    pthread_attr_getstack(&attr, &stack_addr, &stack_size);
+    pthread_attr_destroy(&attr);
+
+    sigevent event = {};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = (pid_t)syscall(SYS_gettid);
+
+    // CPU time of this thread, so only running threads get sampled
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &thread.timer) != 0) {
+        log_error("Could not create sampling timer for thread '{}': {}", name, strerror(errno));
+        return false;
+    }
+
+    strncpy(thread.name, name, sizeof(thread.name) - 1);
+    thread.stack_lo = (uintptr_t)stack_addr;
+    thread.stack_hi = (uintptr_t)stack_addr + stack_size;
+    thread.used = true;
+
+    sampler_thread_index = index;
+
+    if (sampler_running.load(std::memory_order_relaxed)) arm_timer(thread.timer, sampler_interval_ns);
+    return true;
+}
+
+void sampler_unregister_thread() {
+    std::lock_guard<std::mutex> lock(sampler_mutex);
+    const s32 index = sampler_thread_index;
+    if (index < 0) return;
+
+    sampler_thread_index = -1;
+    timer_delete(sampler_threads[index].timer);
+    sampler_threads[index].used = false;
+}
+
+bool sampler_start(u32 frequency_hz, u32 max_samples) {
+    std::lock_guard<std::mutex> lock(sampler_mutex);
+    if (sampler_running.load(std::memory_order_relaxed) || frequency_hz == 0 || max_samples == 0) return false;
+
+    if (!sampler_handler_installed) {
+        struct sigaction action = {};
+        action.sa_sigaction = sampler_handler;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, NULL) != 0) {
+            log_error("Could not install the SIGPROF handler: {}", strerror(errno));
+            return false;
+        }
+        sampler_handler_installed = true;
+    }
+
+    free(sampler_samples);
+    sampler_samples = (Sampler_Sample*)calloc(max_samples, sizeof(Sampler_Sample));
+    if (!sampler_samples) return false;
+
+    sampler_capacity = max_samples;
+    sampler_interval_ns = 1000000000 / frequency_hz;
+    sampler_write_index.store(0, std::memory_order_relaxed);
+    sampler_dropped.store(0, std::memory_order_relaxed);
+    sampler_running.store(true, std::memory_order_release);
+
+    for (const auto& thread : sampler_threads) {
+        if (thread.used) arm_timer(thread.timer, sampler_interval_ns);
+    }
+    return true;
+}
+
+void sampler_stop() {
+    std::lock_guard<std::mutex> lock(sampler_mutex);
+    if (!sampler_running.load(std::memory_order_relaxed)) return;
+
+    sampler_running.store(false, std::memory_order_release);
+    for (const auto& thread : sampler_threads) {
+        if (thread.used) arm_timer(thread.timer, 0);
+    }
+}
+
+static std::string symbolize(void* address) {
+    Dl_info info = {};
+    const bool found = dladdr(address, &info) != 0;
+    if (found && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+        std::string symbol = status == 0 && demangled ? demangled : info.dli_sname;
+        free(demangled);
+        return symbol;
+    }
+
+    char buffer[sizeof(path_str_t) + 32];
+    if (found && info.dli_fname) {
+        str_ptr_t file = strrchr(info.dli_fname, '/');
+        snprintf(buffer, sizeof(buffer), "%s+0x%zx", file ? file + 1 : info.dli_fname, (size_t)((uintptr_t)address - (uintptr_t)info.dli_fbase));
+    } else {
+        snprintf(buffer, sizeof(buffer), "0x%zx", (size_t)address);
+    }
+    return buffer;
+}
+
+bool sampler_write_folded(str_ptr_t path) {
+    std::lock_guard<std::mutex> lock(sampler_mutex);
+    if (sampler_running.load(std::memory_order_relaxed)) {
+        log_error("Stop the sampler before writing its samples");
+        return false;
+    }
+
+    const u32 sample_count = std::min(sampler_write_index.load(std::memory_order_relaxed), sampler_capacity);
+
+    Hash_Map<uintptr_t, std::string> symbols;
+    Hash_Map<std::string, u64> stacks;
+
+    std::string stack;
+    for (u32 i = 0; i < sample_count; i++) {
+        const auto& sample = sampler_samples[i];
+        if (!sample.ready.load(std::memory_order_acquire)) continue;
+
+        stack = sampler_threads[sample.thread].name;
+        for (u32 depth = sample.depth; depth-- > 0;) {
+            // Return addresses point past the call, step back into it
+            const uintptr_t address = (uintptr_t)sample.frames[depth] - (depth > 0 ? 1 : 0);
+
+            auto symbol = symbols.find(address);
+            if (symbol == symbols.end()) symbol = symbols.emplace(address, symbolize((void*)address)).first;
+
+            stack += ';';
+            stack += symbol->second;
+        }
+        stacks[stack]++;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        log_error("Could not open '{}' for writing the sampled stacks", path);
+        return false;
+    }
+    for (const auto& [folded, count] : stacks) {
+        fprintf(file, "%s %llu\n", folded.c_str(), (unsigned long long)count);
+    }
+    fclose(file);
+
+    log_info("Wrote {} samples ({} unique stacks, {} dropped) to '{}'", sample_count, stacks.size(), sampler_dropped.load(std::memory_order_relaxed), path);
+    return true;
+}
+
+NS_END(os)
@@ -0,0 +1,191 @@
+#include "pch.h"
+
+#include "os/stream_reader.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+#define STREAM_BUFFER_COUNT 2
+
+struct Stream_Buffer {
+    byte_t* data;
+    u64 offset;
+    size_t requested;
+
+    async_request_t request;
+    bool pending;
+    s64 bytes;
+    Io_Status status;
+};
+
+struct Stream_Reader_State {
+    File* file = NULL;
+    Async_Io* io = NULL;
+    bool owns_io = false;
+
+    u64 size = 0;
+    size_t chunk_size = 0;
+    byte_t* memory = NULL;
+
+    // Chunk k lives in buffers[k % STREAM_BUFFER_COUNT]
+    Stream_Buffer buffers[STREAM_BUFFER_COUNT] = {};
+    u32 current = 0;
+    bool consuming = false;
+    u64 next_offset = 0;
+
+    u32 stalls = 0;
+};
+
+static void read_complete(const Async_Result& result) {
+    auto buffer = (Stream_Buffer*)result.user_data;
+    buffer->pending = false;
+    buffer->bytes = result.bytes;
+    buffer->status = result.status;
+}
+
+// Nothing is issued past the end, an unissued buffer reads as end of file
+static void issue(Stream_Reader_State* state, Stream_Buffer* buffer) {
+    buffer->offset = state->next_offset;
+    buffer->requested = 0;
+    buffer->bytes = 0;
+    buffer->status = IO_STATUS_OK;
+    buffer->pending = false;
+    if (state->next_offset >= state->size) return;
+
+    buffer->requested = (size_t)std::min<u64>(state->chunk_size, state->size - state->next_offset);
+    state->next_offset += buffer->requested;
+
+    buffer->request = state->io->read(*state->file, buffer->data, buffer->requested, buffer->offset, read_complete, buffer);
+    if (buffer->request) {
+        buffer->pending = true;
+        return;
+    }
+
+    // Every slot of a shared Async_Io is taken, read in place rather than fail
+    buffer->bytes = state->file->read_at(buffer->data, buffer->requested, buffer->offset);
+    if (buffer->bytes < 0) buffer->status = IO_STATUS_UNKNOWN_ERROR;
+}
+
+static void wait_for(Stream_Reader_State* state, Stream_Buffer* buffer) {
+    // Submit again in case a full kernel ring left the request queued
+    while (buffer->pending) {
+        state->io->submit();
+        state->io->poll(true);
+    }
+}
+
+static void cancel_all(Stream_Reader_State* state) {
+    for (auto& buffer : state->buffers) {
+        if (buffer.pending) state->io->cancel(buffer.request);
+    }
+    for (auto& buffer : state->buffers) wait_for(state, &buffer);
+}
+
+Stream_Reader::Stream_Reader(str_ptr_t path, size_t chunk_size, Async_Io* io) {
+    __state = new Stream_Reader_State();
+    if (chunk_size == 0) {
+        _status = IO_STATUS_INVALID_ARGUMENT;
+        return;
+    }
+
+    __state->file = new File(path, FILE_ACCESS_READ);
+    if (__state->file->_status != IO_STATUS_OK) {
+        _status = __state->file->_status;
+        return;
+    }
+
+    __state->io = io;
+    if (!__state->io) {
+        // One request per buffer, a single worker keeps the reads in order without io_uring
+        __state->io = new Async_Io(STREAM_BUFFER_COUNT, 1);
+        __state->owns_io = true;
+    }
+    if (__state->io->_status != IO_STATUS_OK) {
+        _status = __state->io->_status;
+        return;
+    }
+
+    __state->size = __state->file->get_size();
+    __state->chunk_size = chunk_size;
+    __state->memory = (byte_t*)malloc(chunk_size * STREAM_BUFFER_COUNT);
+    if (!__state->memory) {
+        _status = IO_STATUS_OUT_OF_MEMORY;
+        return;
+    }
+    for (u32 i = 0; i < STREAM_BUFFER_COUNT; i++) __state->buffers[i].data = __state->memory + i * chunk_size;
+
+    _status = IO_STATUS_OK;
+    seek(0);
+}
+
+Stream_Reader::~Stream_Reader() {
+    if (__state->io && __state->io->_status == IO_STATUS_OK) cancel_all(__state);
+    if (__state->owns_io) delete __state->io;
+    delete __state->file;
+    free(__state->memory);
+    delete __state;
+}
+
+bool Stream_Reader::next(Stream_Chunk* chunk) {
+    if (_status != IO_STATUS_OK) return false;
+
+    // The chunk handed out last time is done with, refill its buffer
+    if (__state->consuming) {
+        issue(__state, &__state->buffers[__state->current]);
+        __state->io->submit();
+        __state->current = (__state->current + 1) % STREAM_BUFFER_COUNT;
+    }
+
+    auto& buffer = __state->buffers[__state->current];
+    if (buffer.pending) {
+        __state->stalls++;
+        wait_for(__state, &buffer);
+    }
+
+    if (buffer.status != IO_STATUS_OK) {
+        _status = buffer.status;
+        return false;
+    }
+
+    // Short reads before the end are rare but legal, finish them in place
+    if (buffer.bytes >= 0 && (size_t)buffer.bytes < buffer.requested) {
+        const s64 rest = __state->file->read_at(buffer.data + buffer.bytes, buffer.requested - (size_t)buffer.bytes, buffer.offset + (u64)buffer.bytes);
+        if (rest < 0) {
+            _status = IO_STATUS_UNKNOWN_ERROR;
+            return false;
+        }
+        buffer.bytes += rest;
+    }
+
+    __state->consuming = true;
+    if (buffer.bytes <= 0) return false;
+
+    chunk->data = buffer.data;
+    chunk->size = (size_t)buffer.bytes;
+    chunk->offset = buffer.offset;
+    return true;
+}
+
+bool Stream_Reader::seek(u64 offset) {
+    if (_status != IO_STATUS_OK) return false;
+
+    cancel_all(__state);
+    __state->next_offset = std::min(offset, __state->size);
+    __state->current = 0;
+    __state->consuming = false;
+
+    for (auto& buffer : __state->buffers) issue(__state, &buffer);
+    __state->io->submit();
+    return true;
+}
+
+u64 Stream_Reader::get_size() const {
+    return __state->size;
+}
+
+u32 Stream_Reader::get_stall_count() const {
+    return __state->stalls;
+}
+
+NS_END(io)
+NS_END(os)
@@ -0,0 +1,33 @@
+#include "pch.h"
+
+#include "os/async_io.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+// No kernel queue on Windows yet (IOCP or IoRing), Async_Io runs on its thread pool
+
+_Async_Kernel_Queue* _async_kernel_queue_create(u32) {
+    return NULL;
+}
+
+void _async_kernel_queue_destroy(_Async_Kernel_Queue*) {}
+
+bool _async_kernel_queue_push(_Async_Kernel_Queue*, Async_Request*) {
+    return false;
+}
+
+bool _async_kernel_queue_push_cancel(_Async_Kernel_Queue*, Async_Request*) {
+    return false;
+}
+
+u32 _async_kernel_queue_submit(_Async_Kernel_Queue*) {
+    return 0;
+}
+
+u32 _async_kernel_queue_reap(_Async_Kernel_Queue*, bool, void (*)(Async_Request*, s64, Io_Status, void*), void*) {
+    return 0;
+}
+
+NS_END(io)
+NS_END(os)
@@ -0,0 +1,52 @@
+#include "pch.h"
+
+#include "os/crash.h"
+
+#include "logger.h"
+
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "Windows.h"
+
+NS_BEGIN(os)
+
+path_str_t crash_log_path = "";
+
+static void write_crash_report(int fd, DWORD code) {
+    char header[256];
+    const int len = snprintf(header, sizeof(header), 
+        "\n======================================================================================================\n"
+        "Unhandled exception 0x%08lX, last log messages:\n"
+        "======================================================================================================\n", code);
+    _write(fd, header, len);
+    dump_log_ring(fd);
+}
+
+static LONG WINAPI crash_filter(EXCEPTION_POINTERS* info) {
+    const DWORD code = info->ExceptionRecord->ExceptionCode;
+
+    write_crash_report(_fileno(stderr), code);
+
+    if (crash_log_path[0]) {
+        const int fd = _open(crash_log_path, _O_WRONLY | _O_CREAT | _O_TRUNC, _S_IREAD | _S_IWRITE);
+        if (fd >= 0) {
+            write_crash_report(fd, code);
+            _commit(fd);
+            _close(fd);
+        }
+    }
+
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void install_crash_handlers(str_ptr_t log_path) {
+    if (log_path) {
+        strncpy(crash_log_path, log_path, sizeof(crash_log_path) - 1);
+    }
+
+    SetUnhandledExceptionFilter(crash_filter);
+}
+
+NS_END(os)
@@ -0,0 +1,68 @@
+#include "pch.h"
+
+#include "os/directory_scanner.h"
+
+#include "Windows.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+// FILETIME counts 100ns intervals since 1601
+#define FILETIME_UNIX_EPOCH 116444736000000000ull
+
+void* _dir_scan_open_root(str_ptr_t root) {
+    const DWORD attributes = GetFileAttributesA(root);
+    if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) return NULL;
+
+    // Directories are opened by path, there is no handle to keep
+    return (void*)root;
+}
+
+void _dir_scan_close_root(void* root) {
+    (void)root;
+}
+
+bool _dir_scan_read(void* root, str_ptr_t root_path, str_ptr_t relative, u32 flags, _dir_emit_fn_t emit, void* context) {
+    (void)root;
+
+    path_str_t pattern;
+    if (relative[0]) snprintf(pattern, sizeof(pattern), "%s/%s/*", root_path, relative);
+    else snprintf(pattern, sizeof(pattern), "%s/*", root_path);
+
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileExA(pattern, FindExInfoBasic, &data, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE) return GetLastError() == ERROR_FILE_NOT_FOUND;
+
+    do {
+        str_ptr_t name = data.cFileName;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+        // dwReserved0 holds the reparse tag. Other reparse points (dedup, cloud files, ...) are
+        // regular files and directories.
+        const bool link = (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+            (data.dwReserved0 == IO_REPARSE_TAG_SYMLINK || data.dwReserved0 == IO_REPARSE_TAG_MOUNT_POINT);
+
+        Dir_Entry_Type type;
+        if (link)                                                  type = DIR_ENTRY_SYMLINK;
+        else if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) type = DIR_ENTRY_DIRECTORY;
+        else if (data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE)    type = DIR_ENTRY_OTHER;
+        else                                                       type = DIR_ENTRY_FILE;
+
+        // The find data already carries these, no extra cost
+        u64 size = 0, modified_ns = 0;
+        if (flags & DIR_SCAN_STAT) {
+            size = ((u64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+            const u64 filetime = ((u64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+            modified_ns = filetime > FILETIME_UNIX_EPOCH ? (filetime - FILETIME_UNIX_EPOCH) * 100 : 0;
+        }
+
+        emit(context, name, strlen(name), type, size, modified_ns);
+    } while (FindNextFileA(find, &data));
+
+    const bool ok = GetLastError() == ERROR_NO_MORE_FILES;
+    FindClose(find);
+    return ok;
+}
+
+NS_END(io)
+NS_END(os)
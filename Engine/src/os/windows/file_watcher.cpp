@@ -0,0 +1,128 @@
+#include "pch.h"
+
+#include "os/file_watcher.h"
+
+#include "logger.h"
+
+#include "Windows.h"
+
+NS_BEGIN(os)
+NS_BEGIN(io)
+
+#define WATCH_BUFFER_SIZE (64 * 1024)
+#define WATCH_FILTER (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE)
+
+struct _File_Watch_Queue {
+    struct Watch {
+        Dynamic_String directory;
+        bool recursive;
+        HANDLE handle;
+        OVERLAPPED overlapped;
+        DWORD* buffer;
+    };
+    std::vector<Watch*> watches;
+};
+
+static bool issue_read(_File_Watch_Queue::Watch* watch) {
+    return ReadDirectoryChangesW(watch->handle, watch->buffer, WATCH_BUFFER_SIZE, watch->recursive, WATCH_FILTER, NULL, &watch->overlapped, NULL);
+}
+
+_File_Watch_Queue* _file_watch_queue_create() {
+    return new _File_Watch_Queue();
+}
+
+void _file_watch_queue_destroy(_File_Watch_Queue* queue) {
+    for (auto watch : queue->watches) {
+        CancelIoEx(watch->handle, &watch->overlapped);
+        DWORD transferred;
+        GetOverlappedResult(watch->handle, &watch->overlapped, &transferred, TRUE);
+        CloseHandle(watch->overlapped.hEvent);
+        CloseHandle(watch->handle);
+        free(watch->buffer);
+        delete watch;
+    }
+    delete queue;
+}
+
+bool _file_watch_queue_add(_File_Watch_Queue* queue, str_ptr_t directory, bool recursive) {
+    HANDLE handle = CreateFileA(directory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        log_error("Could not watch '{}': error {}", directory, GetLastError());
+        return false;
+    }
+
+    auto watch = new _File_Watch_Queue::Watch();
+    watch->directory = directory;
+    for (auto& c : watch->directory) if (c == '\\') c = '/';
+    while (watch->directory.size() > 1 && watch->directory.back() == '/') watch->directory.pop_back();
+
+    watch->recursive = recursive;
+    watch->handle = handle;
+    watch->overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    // ReadDirectoryChangesW needs a DWORD aligned buffer
+    watch->buffer = (DWORD*)malloc(WATCH_BUFFER_SIZE);
+
+    if (!issue_read(watch)) {
+        log_error("Could not watch '{}': error {}", directory, GetLastError());
+        CloseHandle(watch->overlapped.hEvent);
+        CloseHandle(handle);
+        free(watch->buffer);
+        delete watch;
+        return false;
+    }
+
+    queue->watches.push_back(watch);
+    return true;
+}
+
+void _file_watch_queue_read(_File_Watch_Queue* queue, void (*emit)(str_ptr_t path, u32 changes, void* context), void* context) {
+    for (auto watch : queue->watches) {
+        DWORD transferred = 0;
+        if (!GetOverlappedResult(watch->handle, &watch->overlapped, &transferred, FALSE)) {
+            if (GetLastError() == ERROR_IO_INCOMPLETE) continue;
+        }
+
+        if (transferred == 0) {
+            // The buffer overflowed, nothing but a re-issue to do
+            log_warn("File watcher buffer for '{}' overflowed, some changes were lost", watch->directory);
+        }
+
+        for (DWORD offset = 0; transferred > 0;) {
+            const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)((const byte_t*)watch->buffer + offset);
+
+            char name[sizeof(path_str_t)];
+            const int name_length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), name, sizeof(name) - 1, NULL, NULL);
+            name[name_length] = '\0';
+            for (int i = 0; i < name_length; i++) if (name[i] == '\\') name[i] = '/';
+
+            u32 changes = 0;
+            switch (info->Action) {
+                case FILE_ACTION_MODIFIED:         changes = FILE_CHANGE_MODIFIED; break;
+                case FILE_ACTION_ADDED:
+                case FILE_ACTION_RENAMED_NEW_NAME: changes = FILE_CHANGE_CREATED; break;
+                case FILE_ACTION_REMOVED:
+                case FILE_ACTION_RENAMED_OLD_NAME: changes = FILE_CHANGE_DELETED; break;
+            }
+
+            if (changes) {
+                path_str_t path;
+                snprintf(path, sizeof(path), "%s/%s", watch->directory.c_str(), name);
+
+                // Directory entries show up here too, only report files
+                const DWORD attributes = GetFileAttributesA(path);
+                if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) emit(path, changes, context);
+            }
+
+            if (!info->NextEntryOffset) break;
+            offset += info->NextEntryOffset;
+        }
+
+        ResetEvent(watch->overlapped.hEvent);
+        issue_read(watch);
+    }
+}
+
+NS_END(io)
+NS_END(os)
@@ -1,12 +1,206 @@
 #include "pch.h"
 
-#include "io.h"
+#include "os/io.h"
 
 #include "Windows.h"
 
 NS_BEGIN(os)
 NS_BEGIN(io)
 
+static Io_Status error_to_status(DWORD error) {
+    switch (error) {
+        case ERROR_FILE_NOT_FOUND:
+        case ERROR_PATH_NOT_FOUND:
+            return IO_STATUS_FILE_NOT_FOUND;
+        case ERROR_ACCESS_DENIED:
+        case ERROR_SHARING_VIOLATION:
+            return IO_STATUS_ACCESS_DENIED;
+        case ERROR_INVALID_PARAMETER:
+            return IO_STATUS_INVALID_ARGUMENT;
+        case ERROR_FILE_EXISTS:
+        case ERROR_ALREADY_EXISTS:
+            return IO_STATUS_ALREADY_EXISTS;
+        case ERROR_NOT_ENOUGH_MEMORY:
+        case ERROR_COMMITMENT_LIMIT:
+            return IO_STATUS_OUT_OF_MEMORY;
+        default:
+            return IO_STATUS_UNKNOWN_ERROR;
+    }
+}
+
+File::File(str_ptr_t path, File_Access access, u32 flags) : access(access) {
+    DWORD desired_access = 0;
+    switch (access) {
+        case FILE_ACCESS_READ:       desired_access = GENERIC_READ; break;
+        case FILE_ACCESS_WRITE:      desired_access = GENERIC_WRITE; break;
+        case FILE_ACCESS_READ_WRITE: desired_access = GENERIC_READ | GENERIC_WRITE; break;
+    }
+
+    DWORD disposition = OPEN_EXISTING;
+    if ((flags & FILE_FLAG_CREATE) && (flags & FILE_FLAG_TRUNCATE)) disposition = CREATE_ALWAYS;
+    else if (flags & FILE_FLAG_CREATE) disposition = OPEN_ALWAYS;
+    else if (flags & FILE_FLAG_TRUNCATE) disposition = TRUNCATE_EXISTING;
+    // A new file is empty, truncate has nothing left to do
+    if ((flags & FILE_FLAG_CREATE) && (flags & FILE_FLAG_EXCLUSIVE)) disposition = CREATE_NEW;
+
+    HANDLE file = CreateFileA(path, desired_access, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, disposition, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        _status = error_to_status(GetLastError());
+        return;
+    }
+
+    __os_handle = file;
+    _status = IO_STATUS_OK;
+}
+
+File::~File() {
+    if (_status == IO_STATUS_OK) CloseHandle(__os_handle);
+}
+
+// Positional transfers through OVERLAPPED offsets on a synchronous handle
+
+s64 File::read_at(void* buffer, size_t size, u64 offset) const {
+    if (_status != IO_STATUS_OK) return -1;
+
+    size_t total = 0;
+    while (total < size) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)(offset + total);
+        overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+
+        const DWORD chunk = (DWORD)std::min<size_t>(size - total, 0x80000000);
+        DWORD n = 0;
+        if (!ReadFile(__os_handle, (byte_t*)buffer + total, chunk, &n, &overlapped)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) break;
+            return -1;
+        }
+        if (n == 0) break;
+        total += n;
+    }
+    return (s64)total;
+}
+
+s64 File::write_at(const void* buffer, size_t size, u64 offset) const {
+    if (_status != IO_STATUS_OK) return -1;
+
+    size_t total = 0;
+    while (total < size) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)(offset + total);
+        overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+
+        const DWORD chunk = (DWORD)std::min<size_t>(size - total, 0x80000000);
+        DWORD n = 0;
+        if (!WriteFile(__os_handle, (const byte_t*)buffer + total, chunk, &n, &overlapped)) return -1;
+        total += n;
+    }
+    return (s64)total;
+}
+
+u64 File::get_size() const {
+    LARGE_INTEGER size;
+    if (_status != IO_STATUS_OK || !GetFileSizeEx(__os_handle, &size)) return 0;
+    return (u64)size.QuadPart;
+}
+
+bool File::sync() const {
+    if (_status != IO_STATUS_OK) return false;
+    return FlushFileBuffers(__os_handle);
+}
+
+bool File::preallocate(u64 size) const {
+    if (_status != IO_STATUS_OK || size == 0) return false;
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = (LONGLONG)size;
+    return SetFileInformationByHandle(__os_handle, FileAllocationInfo, &info, sizeof(info));
+}
+
+Mapped_File::Mapped_File(str_ptr_t path, Mapping_Access access, u32 flags) : access(access) {
+    const bool writable = access == MAPPING_ACCESS_READ_WRITE;
+
+    // Windows only takes access hints when the file is opened
+    DWORD file_flags = FILE_ATTRIBUTE_NORMAL;
+    if (flags & MAPPING_FLAG_SEQUENTIAL) file_flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    if (flags & MAPPING_FLAG_RANDOM) file_flags |= FILE_FLAG_RANDOM_ACCESS;
+
+    HANDLE file = CreateFileA(path, GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ, NULL, OPEN_EXISTING, file_flags, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        _status = error_to_status(GetLastError());
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        _status = error_to_status(GetLastError());
+        CloseHandle(file);
+        return;
+    }
+
+    size = (size_t)file_size.QuadPart;
+    if (size == 0) {
+        CloseHandle(file);
+        _status = IO_STATUS_OK;
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        _status = error_to_status(GetLastError());
+        CloseHandle(file);
+        size = 0;
+        return;
+    }
+
+    data = (byte_t*)MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+
+    // The view keeps the mapping alive, the file handle is kept for flush
+    CloseHandle(mapping);
+
+    if (!data) {
+        _status = error_to_status(GetLastError());
+        CloseHandle(file);
+        size = 0;
+        return;
+    }
+
+    __os_handle = file;
+    _status = IO_STATUS_OK;
+
+    if (flags & MAPPING_FLAG_PREFAULT) advise(MAPPING_FLAG_PREFAULT);
+}
+
+Mapped_File::~Mapped_File() {
+    if (data) UnmapViewOfFile(data);
+    if (__os_handle) CloseHandle(__os_handle);
+}
+
+void Mapped_File::advise(u32 flags, size_t offset, size_t range_size) {
+    if (!data || offset >= size) return;
+
+    // Sequential and random hints only exist at open time, only prefaulting can be done later
+    if (!(flags & MAPPING_FLAG_PREFAULT)) return;
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = data + offset;
+    range.NumberOfBytes = range_size == 0 || range_size > size - offset ? size - offset : range_size;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+bool Mapped_File::flush() {
+    if (_status != IO_STATUS_OK) return false;
+    if (!data || access != MAPPING_ACCESS_READ_WRITE) return true;
+    return FlushViewOfFile(data, 0) && FlushFileBuffers(__os_handle);
+}
+
+bool ST_API replace_file(str_ptr_t from, str_ptr_t to) {
+    // Write through makes the call return only once the rename is on disk
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+bool ST_API remove_file(str_ptr_t path) {
+    return DeleteFileA(path);
+}
+
 New_String ST_API get_exe_path() {
     New_String result(MAX_PATH);
     GetModuleFileNameA(NULL, result.str, MAX_PATH);
@@ -14,4 +208,4 @@ New_String ST_API get_exe_path() {
 }
 
 NS_END(io)
-NS_END(os)
\ No newline at end of file
+NS_END(os)
@@ -0,0 +1,19 @@
+#include "pch.h"
+
+#include "os/perf_counters.h"
+
+NS_BEGIN(os)
+
+// Hardware counters need a kernel driver on Windows
+
+bool open_thread_perf_counters() {
+    return false;
+}
+
+void close_thread_perf_counters() {}
+
+bool read_thread_perf_counters(Perf_Counter_Values*) {
+    return false;
+}
+
+NS_END(os)
@@ -0,0 +1,25 @@
+#include "pch.h"
+
+#include "os/sampler.h"
+
+NS_BEGIN(os)
+
+// Not implemented on Windows, use ETW based tools instead
+
+bool sampler_register_thread(str_ptr_t) {
+    return false;
+}
+
+void sampler_unregister_thread() {}
+
+bool sampler_start(u32, u32) {
+    return false;
+}
+
+void sampler_stop() {}
+
+bool sampler_write_folded(str_ptr_t) {
+    return false;
+}
+
+NS_END(os)
@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "pack.h"
+#include "hash.h"
+#include "lz4.h"
+
+#include <algorithm>
+
+Pack_Archive::Pack_Archive(str_ptr_t path) : file(path, os::io::MAPPING_ACCESS_READ_ONLY, os::io::MAPPING_FLAG_RANDOM) {
+    if (file._status != os::io::IO_STATUS_OK) {
+        _status = file._status;
+        return;
+    }
+
+    // Validate everything up front so lookups don't need bounds checks
+    _status = os::io::IO_STATUS_INVALID_FORMAT;
+    if (file.size < sizeof(Pack_Header)) return;
+
+    const Pack_Header* header = (const Pack_Header*)file.data;
+    if (header->magic != PACK_MAGIC || header->version != PACK_VERSION) return;
+
+    const u64 index_size = (u64)header->entry_count * sizeof(Pack_Entry);
+    if (header->index_offset % alignof(Pack_Entry) != 0) return;
+    if (header->index_offset > file.size || index_size > file.size - header->index_offset) return;
+    if (header->names_offset > file.size || header->names_size > file.size - header->names_offset) return;
+
+    const Pack_Entry* index = (const Pack_Entry*)(file.data + header->index_offset);
+    for (u32 i = 0; i < header->entry_count; i++) {
+        const auto& entry = index[i];
+        if (entry.offset > file.size || entry.stored_size > file.size - entry.offset) return;
+        if (!(entry.flags & PACK_ENTRY_FLAG_LZ4) && entry.stored_size != entry.size) return;
+        if ((u64)entry.name_offset + entry.name_length >= header->names_size) return;
+        if (file.data[header->names_offset + entry.name_offset + entry.name_length] != '\0') return;
+        if (i > 0 && index[i - 1].path_hash > entry.path_hash) return;
+    }
+
+    entries = index;
+    entry_count = header->entry_count;
+    _status = os::io::IO_STATUS_OK;
+}
+
+const Pack_Entry* Pack_Archive::find(str_ptr_t path) const {
+    return find(path, fnv1a_64(path));
+}
+
+const Pack_Entry* Pack_Archive::find(str_ptr_t path, u64 path_hash) const {
+    const Pack_Entry* end = entries + entry_count;
+    const Pack_Entry* it = std::lower_bound(entries, end, path_hash, [](const Pack_Entry& entry, u64 hash) { return entry.path_hash < hash; });
+
+    // Compare names to rule out hash collisions
+    for (; it != end && it->path_hash == path_hash; it++) {
+        if (strcmp(get_name(*it), path) == 0) return it;
+    }
+    return NULL;
+}
+
+str_ptr_t Pack_Archive::get_name(const Pack_Entry& entry) const {
+    const Pack_Header* header = (const Pack_Header*)file.data;
+    return (str_ptr_t)(file.data + header->names_offset + entry.name_offset);
+}
+
+const byte_t* Pack_Archive::get_data(const Pack_Entry& entry) const {
+    return file.data + entry.offset;
+}
+
+bool Pack_Archive::read(const Pack_Entry& entry, byte_t* dst) const {
+    if (entry.flags & PACK_ENTRY_FLAG_LZ4) {
+        return lz4_decompress(get_data(entry), entry.stored_size, dst, entry.size) == (s64)entry.size;
+    }
+    memcpy(dst, get_data(entry), entry.size);
+    return true;
+}
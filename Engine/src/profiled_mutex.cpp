@@ -0,0 +1,68 @@
+#include "pch.h"
+
+#include "profiled_mutex.h"
+#include "logger.h"
+
+Lock_Stats lock_stats[MAX_PROFILED_LOCKS];
+std::atomic<u32> lock_stats_count = 0;
+std::mutex lock_stats_mutex;
+
+// Shared by every lock once the registry is full
+Lock_Stats overflow_lock_stats;
+
+Lock_Stats* register_lock_stats(str_ptr_t name) {
+    std::lock_guard<std::mutex> lock(lock_stats_mutex);
+
+    const u32 count = lock_stats_count.load(std::memory_order_relaxed);
+    for (u32 i = 0; i < count; i++) {
+        if (strcmp(lock_stats[i].name, name) == 0) return &lock_stats[i];
+    }
+
+    if (count >= MAX_PROFILED_LOCKS) {
+        strcpy(overflow_lock_stats.name, "(overflow)");
+        strcpy(overflow_lock_stats.wait_zone, "Lock wait: (overflow)");
+        return &overflow_lock_stats;
+    }
+
+    auto& stats = lock_stats[count];
+    strncpy(stats.name, name, sizeof(stats.name) - 1);
+    // Formatted from name, reading stats.name would overlap the destination object
+    snprintf(stats.wait_zone, sizeof(stats.wait_zone), "Lock wait: %.*s", (int)strlen(stats.name), name);
+    lock_stats_count.store(count + 1, std::memory_order_release);
+
+    return &stats;
+}
+
+u32 get_lock_stats(Lock_Stats** stats) {
+    *stats = lock_stats;
+    return lock_stats_count.load(std::memory_order_acquire);
+}
+
+void reset_lock_stats() {
+    const u32 count = lock_stats_count.load(std::memory_order_acquire);
+    for (u32 i = 0; i < count; i++) {
+        auto& stats = lock_stats[i];
+        stats.acquisitions = 0;
+        stats.contentions = 0;
+        stats.wait_ns = 0;
+        stats.max_wait_ns = 0;
+        stats.hold_ns = 0;
+        stats.max_hold_ns = 0;
+    }
+}
+
+void log_lock_stats() {
+    const u32 count = lock_stats_count.load(std::memory_order_acquire);
+    for (u32 i = 0; i < count; i++) {
+        const auto& stats = lock_stats[i];
+        const u64 acquisitions = stats.acquisitions.load(std::memory_order_relaxed);
+        if (acquisitions == 0) continue;
+
+        log_info_kv("Lock stats", {"lock", stats.name}, {"acquisitions", acquisitions}, 
+            {"contentions", stats.contentions.load(std::memory_order_relaxed)},
+            {"wait_ms", stats.wait_ns.load(std::memory_order_relaxed) / 1000000.0},
+            {"max_wait_us", stats.max_wait_ns.load(std::memory_order_relaxed) / 1000.0},
+            {"hold_ms", stats.hold_ns.load(std::memory_order_relaxed) / 1000000.0},
+            {"max_hold_us", stats.max_hold_ns.load(std::memory_order_relaxed) / 1000.0});
+    }
+}
@@ -0,0 +1,385 @@
+#include "pch.h"
+
+#include "profiler.h"
+#include "logger.h"
+#include "json.h"
+
+#include <chrono>
+#include <algorithm>
+
+#define PROFILER_EVENTS_PER_CHUNK 4096
+#define PROFILER_MAX_ZONE_DEPTH 128
+
+struct Profile_Chunk {
+    std::atomic<u32> count = 0;
+    std::atomic<Profile_Chunk*> next = NULL;
+    Profile_Zone_Event events[PROFILER_EVENTS_PER_CHUNK];
+};
+
+struct Open_Zone {
+    str_ptr_t name;
+    u64 begin_ns;
+    os::Perf_Counter_Values counters;
+};
+
+// Only the owning thread writes to a buffer. Readers see complete events through the
+// release store of count, and chunks are never freed so they can be read at any time.
+struct Thread_Profile_Buffer {
+    u32 thread_index;
+    name_str_t name;
+
+    Profile_Chunk* first;
+    Profile_Chunk* current;
+
+    // Session the events belong to, the owner rewinds the buffer when a new one starts.
+    // Read by profiler_end_session while the owner may be writing it.
+    std::atomic<u32> session;
+
+    Open_Zone stack[PROFILER_MAX_ZONE_DEPTH];
+    u32 depth = 0;
+
+    // 0 untried, 1 open, -1 unavailable
+    s8 counters_state = 0;
+};
+
+std::atomic<bool> _profiler_recording = false;
+
+std::atomic<bool> profiler_session_active = false;
+std::atomic<bool> profiler_frame_capture = false;
+std::atomic<bool> profiler_hw_counters = false;
+
+std::atomic<u32> profiler_session = 0;
+u64 profiler_session_start_ns = 0;
+
+std::mutex profiler_threads_mutex;
+std::vector<Thread_Profile_Buffer*> profiler_threads;
+
+thread_local Thread_Profile_Buffer* profiler_thread_buffer = NULL;
+
+// Everything below is owned by the frame thread
+Thread_Profile_Buffer* profiler_frame_thread = NULL;
+Profile_Chunk* frame_start_chunk = NULL;
+u32 frame_start_index = 0;
+u64 frame_begin_ns = 0;
+
+Profile_Frame profiler_frames[2];
+u32 profiler_front_frame = 0;
+Profile_Frame_History profiler_history;
+std::vector<Profile_Zone_Event> frame_events;
+
+static void update_recording() {
+    _profiler_recording.store(profiler_session_active.load() || profiler_frame_capture.load(), std::memory_order_release);
+}
+
+u64 profiler_now_ns() {
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static Thread_Profile_Buffer* get_thread_buffer() {
+    if (profiler_thread_buffer) return profiler_thread_buffer;
+
+    auto buffer = new Thread_Profile_Buffer();
+    buffer->first = buffer->current = new Profile_Chunk();
+    buffer->session.store(profiler_session.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(profiler_threads_mutex);
+    buffer->thread_index = (u32)profiler_threads.size();
+    snprintf(buffer->name, sizeof(buffer->name), "Thread %u", buffer->thread_index);
+    profiler_threads.push_back(buffer);
+
+    profiler_thread_buffer = buffer;
+    return buffer;
+}
+
+static void rewind_buffer(Thread_Profile_Buffer* buffer) {
+    for (auto chunk = buffer->first; chunk; chunk = chunk->next.load(std::memory_order_relaxed)) {
+        chunk->count.store(0, std::memory_order_relaxed);
+    }
+    buffer->current = buffer->first;
+
+    if (buffer == profiler_frame_thread) {
+        frame_start_chunk = buffer->first;
+        frame_start_index = 0;
+    }
+}
+
+static void push_event(Thread_Profile_Buffer* buffer, const Profile_Zone_Event& event) {
+    auto chunk = buffer->current;
+    u32 count = chunk->count.load(std::memory_order_relaxed);
+
+    if (count == PROFILER_EVENTS_PER_CHUNK) {
+        auto next = chunk->next.load(std::memory_order_relaxed);
+        if (!next) {
+            next = new Profile_Chunk();
+            chunk->next.store(next, std::memory_order_release);
+        }
+        chunk = buffer->current = next;
+        count = 0;
+    }
+
+    chunk->events[count] = event;
+    chunk->count.store(count + 1, std::memory_order_release);
+}
+
+void _profiler_zone_begin(str_ptr_t name) {
+    auto buffer = get_thread_buffer();
+
+    const u32 session = profiler_session.load(std::memory_order_acquire);
+    if (buffer->session.load(std::memory_order_relaxed) != session) {
+        rewind_buffer(buffer);
+        buffer->session.store(session, std::memory_order_release);
+    }
+
+    if (buffer->depth < PROFILER_MAX_ZONE_DEPTH) {
+        auto& zone = buffer->stack[buffer->depth];
+        zone.name = name;
+        zone.counters = {};
+        if (profiler_hw_counters.load(std::memory_order_relaxed)) {
+            if (buffer->counters_state == 0) buffer->counters_state = os::open_thread_perf_counters() ? 1 : -1;
+            if (buffer->counters_state > 0) os::read_thread_perf_counters(&zone.counters);
+        }
+        zone.begin_ns = profiler_now_ns();
+    }
+    buffer->depth++;
+}
+
+void _profiler_zone_end() {
+    const u64 end_ns = profiler_now_ns();
+    auto buffer = get_thread_buffer();
+
+    if (buffer->depth == 0) return;
+    buffer->depth--;
+
+    // Without a session only the frame thread records, and rewinds every frame
+    if (!profiler_session_active.load(std::memory_order_relaxed) && buffer != profiler_frame_thread) return;
+
+    if (buffer->depth < PROFILER_MAX_ZONE_DEPTH) {
+        const auto& zone = buffer->stack[buffer->depth];
+
+        os::Perf_Counter_Values counters = {};
+        if (buffer->counters_state > 0 && profiler_hw_counters.load(std::memory_order_relaxed) && 
+            (zone.counters.cycles || zone.counters.instructions) && os::read_thread_perf_counters(&counters)) {
+            counters.instructions -= zone.counters.instructions;
+            counters.cycles -= zone.counters.cycles;
+            counters.cache_misses -= zone.counters.cache_misses;
+            counters.branch_misses -= zone.counters.branch_misses;
+        }
+
+        push_event(buffer, { zone.name, zone.begin_ns, end_ns, buffer->depth, counters });
+    }
+}
+
+void profiler_set_thread_name(str_ptr_t name) {
+    auto buffer = get_thread_buffer();
+    std::lock_guard<std::mutex> lock(profiler_threads_mutex);
+    strncpy(buffer->name, name, sizeof(buffer->name) - 1);
+}
+
+bool profiler_enable_hw_counters(bool enabled) {
+    if (enabled && !os::open_thread_perf_counters()) {
+        log_warn("Hardware performance counters are not available, check /proc/sys/kernel/perf_event_paranoid");
+        return false;
+    }
+    profiler_hw_counters.store(enabled);
+    return true;
+}
+
+bool profiler_hw_counters_enabled() {
+    return profiler_hw_counters.load(std::memory_order_relaxed);
+}
+
+void profiler_begin_session() {
+    profiler_session.fetch_add(1, std::memory_order_acq_rel);
+    profiler_session_start_ns = profiler_now_ns();
+    profiler_session_active.store(true);
+    update_recording();
+}
+
+static void flush_trace(FILE* file, spdlog::memory_buf_t& buf) {
+    fwrite(buf.data(), 1, buf.size(), file);
+    buf.clear();
+}
+
+bool profiler_end_session(str_ptr_t trace_path) {
+    profiler_session_active.store(false);
+    update_recording();
+
+    FILE* file = fopen(trace_path, "wb");
+    if (!file) {
+        log_error("Could not open '{}' to write the profiler trace", trace_path);
+        return false;
+    }
+
+    const u32 session = profiler_session.load(std::memory_order_acquire);
+    size_t event_count = 0;
+
+    spdlog::memory_buf_t buf;
+    json_append_raw(buf, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first_event = true;
+
+    std::lock_guard<std::mutex> lock(profiler_threads_mutex);
+    for (auto buffer : profiler_threads) {
+        if (!first_event) buf.push_back(',');
+        first_event = false;
+
+        fmt::format_to(std::back_inserter(buf), "\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":", buffer->thread_index);
+        json_append_string(buf, buffer->name);
+        json_append_raw(buf, "}}");
+
+        if (buffer->session.load(std::memory_order_acquire) != session) continue;
+
+        for (auto chunk = buffer->first; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+            const u32 count = chunk->count.load(std::memory_order_acquire);
+            for (u32 i = 0; i < count; i++) {
+                const auto& event = chunk->events[i];
+                if (event.begin_ns < profiler_session_start_ns) continue;
+
+                json_append_raw(buf, ",\n{\"name\":");
+                json_append_string(buf, event.name);
+                fmt::format_to(std::back_inserter(buf), ",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+                    buffer->thread_index, (event.begin_ns - profiler_session_start_ns) / 1000.0, (event.end_ns - event.begin_ns) / 1000.0);
+                if (event.counters.cycles) {
+                    const auto& counters = event.counters;
+                    fmt::format_to(std::back_inserter(buf), ",\"args\":{{\"instructions\":{},\"cycles\":{},\"ipc\":{:.3f},\"cache_misses\":{},\"branch_misses\":{}}}",
+                        counters.instructions, counters.cycles, (f64)counters.instructions / counters.cycles, counters.cache_misses, counters.branch_misses);
+                }
+                buf.push_back('}');
+                event_count++;
+
+                if (buf.size() > 64 * 1024) flush_trace(file, buf);
+            }
+            if (count < PROFILER_EVENTS_PER_CHUNK) break;
+        }
+    }
+
+    json_append_raw(buf, "\n]}\n");
+    flush_trace(file, buf);
+    fclose(file);
+
+    log_info("Wrote {} profiler zones to '{}'", event_count, trace_path);
+    return true;
+}
+
+void profiler_set_frame_capture(bool enabled) {
+    profiler_frame_capture.store(enabled);
+    update_recording();
+}
+
+static bool same_zone(str_ptr_t a, str_ptr_t b) {
+    return a == b || strcmp(a, b) == 0;
+}
+
+static void build_frame(Profile_Frame& frame, std::vector<Profile_Zone_Event>& events) {
+    frame.nodes.clear();
+    if (events.empty()) return;
+
+    // Events are recorded as zones end, order them so parents come before their children
+    std::sort(events.begin(), events.end(), [](const Profile_Zone_Event& a, const Profile_Zone_Event& b) {
+        return a.begin_ns != b.begin_ns ? a.begin_ns < b.begin_ns : a.depth < b.depth;
+    });
+
+    // Zones still open at the current event, events whose parent started before the frame
+    // become roots and their children nest under them
+    struct Open_Node {
+        s32 node;
+        u32 event_depth;
+        u64 end_ns;
+    };
+    Open_Node open_nodes[PROFILER_MAX_ZONE_DEPTH];
+    u32 open_count = 0;
+    s32 last_root = -1;
+
+    for (const auto& event : events) {
+        while (open_count > 0 && (open_nodes[open_count - 1].event_depth >= event.depth || open_nodes[open_count - 1].end_ns <= event.begin_ns)) {
+            open_count--;
+        }
+
+        const u32 depth = open_count;
+        const s32 parent = open_count > 0 ? open_nodes[open_count - 1].node : -1;
+
+        s32 node = parent >= 0 ? frame.nodes[parent].first_child : (frame.nodes.empty() ? -1 : 0);
+        s32 last_sibling = -1;
+        while (node >= 0 && !same_zone(frame.nodes[node].name, event.name)) {
+            last_sibling = node;
+            node = frame.nodes[node].next_sibling;
+        }
+
+        if (node < 0) {
+            node = (s32)frame.nodes.size();
+            frame.nodes.push_back({ event.name, 0, 0, depth, {}, parent, -1, -1 });
+
+            if (last_sibling >= 0) frame.nodes[last_sibling].next_sibling = node;
+            else if (parent >= 0) frame.nodes[parent].first_child = node;
+            else if (last_root >= 0) frame.nodes[last_root].next_sibling = node;
+            if (parent < 0) last_root = node;
+        }
+
+        auto& merged = frame.nodes[node];
+        merged.total_ns += event.end_ns - event.begin_ns;
+        merged.calls++;
+        merged.counters.instructions += event.counters.instructions;
+        merged.counters.cycles += event.counters.cycles;
+        merged.counters.cache_misses += event.counters.cache_misses;
+        merged.counters.branch_misses += event.counters.branch_misses;
+        if (open_count < PROFILER_MAX_ZONE_DEPTH) open_nodes[open_count++] = { node, event.depth, event.end_ns };
+    }
+}
+
+void profiler_frame_mark() {
+    const u64 now = profiler_now_ns();
+    auto buffer = get_thread_buffer();
+
+    if (!profiler_frame_thread) {
+        profiler_frame_thread = buffer;
+        frame_start_chunk = buffer->current;
+        frame_start_index = buffer->current->count.load(std::memory_order_relaxed);
+        frame_begin_ns = now;
+        return;
+    }
+    st_assert(buffer == profiler_frame_thread, "profiler_frame_mark must always be called from the same thread");
+
+    auto& frame = profiler_frames[1 - profiler_front_frame];
+    frame.index = profiler_history.count;
+    frame.begin_ns = frame_begin_ns;
+    frame.end_ns = now;
+
+    frame_events.clear();
+    if (_profiler_recording.load(std::memory_order_relaxed)) {
+        u32 start = frame_start_index;
+        for (auto chunk = frame_start_chunk; chunk; chunk = chunk->next.load(std::memory_order_relaxed)) {
+            const u32 count = chunk->count.load(std::memory_order_relaxed);
+            for (u32 i = start; i < count; i++) {
+                if (chunk->events[i].begin_ns >= frame_begin_ns) frame_events.push_back(chunk->events[i]);
+            }
+            if (chunk == buffer->current) break;
+            start = 0;
+        }
+    }
+    build_frame(frame, frame_events);
+    profiler_front_frame = 1 - profiler_front_frame;
+
+    auto& stat = profiler_history.frames[profiler_history.count % PROFILER_FRAME_HISTORY];
+    stat = { frame.index, frame.begin_ns, frame.end_ns - frame.begin_ns, NULL, 0 };
+    for (s32 node = frame.nodes.empty() ? -1 : 0; node >= 0; node = frame.nodes[node].next_sibling) {
+        if (frame.nodes[node].total_ns > stat.top_zone_ns) {
+            stat.top_zone = frame.nodes[node].name;
+            stat.top_zone_ns = frame.nodes[node].total_ns;
+        }
+    }
+    profiler_history.count++;
+
+    if (!profiler_session_active.load(std::memory_order_relaxed)) {
+        rewind_buffer(buffer);
+    }
+    frame_start_chunk = buffer->current;
+    frame_start_index = buffer->current->count.load(std::memory_order_relaxed);
+    frame_begin_ns = now;
+}
+
+const Profile_Frame* profiler_last_frame() {
+    return profiler_history.count > 0 ? &profiler_frames[profiler_front_frame] : NULL;
+}
+
+const Profile_Frame_History& profiler_frame_history() {
+    return profiler_history;
+}
@@ -0,0 +1,208 @@
+#include "pch.h"
+
+#include "profiler.h"
+#include "profiled_mutex.h"
+
+#include <imgui.h>
+
+#define PROFILER_GRAPH_FRAMES 256
+#define PROFILER_WORST_FRAMES 8
+
+bool profiler_gui_capture = false;
+bool profiler_gui_paused = false;
+Profile_Frame profiler_gui_paused_frame;
+f32 profiler_gui_worst_window_seconds = 10.f;
+
+static void do_zone_tree(const Profile_Frame& frame, s32 node_index, f64 frame_ms, bool counters) {
+    for (; node_index >= 0; node_index = frame.nodes[node_index].next_sibling) {
+        const auto& node = frame.nodes[node_index];
+        const f64 ms = node.total_ns / 1000000.0;
+
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth;
+        if (node.first_child < 0) flags |= ImGuiTreeNodeFlags_Leaf;
+        if (node.depth < 2) flags |= ImGuiTreeNodeFlags_DefaultOpen;
+
+        const bool open = ImGui::TreeNodeEx((void*)(intptr_t)node_index, flags, "%s", node.name);
+
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", ms);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f%%", frame_ms > 0 ? ms / frame_ms * 100.0 : 0.0);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", node.calls);
+
+        if (counters) {
+            ImGui::TableNextColumn();
+            if (node.counters.cycles) ImGui::Text("%.2f", (f64)node.counters.instructions / node.counters.cycles);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)node.counters.cache_misses);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)node.counters.branch_misses);
+        }
+
+        if (open) {
+            do_zone_tree(frame, node.first_child, frame_ms, counters);
+            ImGui::TreePop();
+        }
+    }
+}
+
+static void do_frame_graph(const Profile_Frame_History& history) {
+    f32 values[PROFILER_GRAPH_FRAMES];
+    const u64 count = history.count < PROFILER_GRAPH_FRAMES ? history.count : PROFILER_GRAPH_FRAMES;
+
+    f32 max_ms = 0.f;
+    f64 total_ms = 0.0;
+    for (u64 i = 0; i < count; i++) {
+        const auto& stat = history.frames[(history.count - count + i) % PROFILER_FRAME_HISTORY];
+        values[i] = (f32)(stat.duration_ns / 1000000.0);
+        total_ms += values[i];
+        if (values[i] > max_ms) max_ms = values[i];
+    }
+
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "avg %.2f ms, max %.2f ms", count ? total_ms / count : 0.0, max_ms);
+    ImGui::PlotLines("##frame_times", values, (int)count, 0, overlay, 0.f, max_ms * 1.2f, ImVec2(0, 80));
+}
+
+static void do_worst_frames(const Profile_Frame_History& history) {
+    ImGui::SliderFloat("Window (s)", &profiler_gui_worst_window_seconds, 1.f, 60.f, "%.0f");
+
+    if (history.count == 0) return;
+
+    const auto& newest = history.frames[(history.count - 1) % PROFILER_FRAME_HISTORY];
+    const u64 window_ns = (u64)(profiler_gui_worst_window_seconds * 1000000000.0);
+    const u64 oldest_count = history.count < PROFILER_FRAME_HISTORY ? history.count : PROFILER_FRAME_HISTORY;
+
+    const Profile_Frame_Stat* worst[PROFILER_WORST_FRAMES] = {};
+    for (u64 i = 0; i < oldest_count; i++) {
+        const auto& stat = history.frames[(history.count - 1 - i) % PROFILER_FRAME_HISTORY];
+        if (newest.begin_ns - stat.begin_ns > window_ns) break;
+
+        // Insertion into the sorted worst list
+        for (u32 slot = 0; slot < PROFILER_WORST_FRAMES; slot++) {
+            if (!worst[slot] || stat.duration_ns > worst[slot]->duration_ns) {
+                for (u32 j = PROFILER_WORST_FRAMES - 1; j > slot; j--) worst[j] = worst[j - 1];
+                worst[slot] = &stat;
+                break;
+            }
+        }
+    }
+
+    if (ImGui::BeginTable("worst_frames", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersV)) {
+        ImGui::TableSetupColumn("Frame");
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableSetupColumn("Top zone");
+        ImGui::TableHeadersRow();
+
+        for (auto stat : worst) {
+            if (!stat) break;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)stat->index);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stat->duration_ns / 1000000.0);
+            ImGui::TableNextColumn();
+            if (stat->top_zone) ImGui::Text("%s (%.3f ms)", stat->top_zone, stat->top_zone_ns / 1000000.0);
+        }
+        ImGui::EndTable();
+    }
+}
+
+static void do_lock_stats() {
+    Lock_Stats* stats;
+    const u32 count = get_lock_stats(&stats);
+
+    if (ImGui::Button("Reset")) reset_lock_stats();
+
+    if (ImGui::BeginTable("locks", 7, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersV)) {
+        ImGui::TableSetupColumn("Lock", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Acquired");
+        ImGui::TableSetupColumn("Contended");
+        ImGui::TableSetupColumn("Wait ms");
+        ImGui::TableSetupColumn("Max wait us");
+        ImGui::TableSetupColumn("Hold ms");
+        ImGui::TableSetupColumn("Max hold us");
+        ImGui::TableHeadersRow();
+
+        for (u32 i = 0; i < count; i++) {
+            const auto& lock = stats[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(lock.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)lock.acquisitions.load(std::memory_order_relaxed));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)lock.contentions.load(std::memory_order_relaxed));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", lock.wait_ns.load(std::memory_order_relaxed) / 1000000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", lock.max_wait_ns.load(std::memory_order_relaxed) / 1000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", lock.hold_ns.load(std::memory_order_relaxed) / 1000000.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", lock.max_hold_ns.load(std::memory_order_relaxed) / 1000.0);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void profiler_do_gui(bool* open) {
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::Checkbox("Capture zones", &profiler_gui_capture)) {
+        profiler_set_frame_capture(profiler_gui_capture);
+    }
+    ImGui::SameLine();
+    bool counters = profiler_hw_counters_enabled();
+    if (ImGui::Checkbox("HW counters", &counters)) {
+        profiler_enable_hw_counters(counters);
+    }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Pause", &profiler_gui_paused) && profiler_gui_paused) {
+        if (auto last = profiler_last_frame()) profiler_gui_paused_frame = *last;
+    }
+
+    const auto& history = profiler_frame_history();
+    do_frame_graph(history);
+
+    const Profile_Frame* frame = profiler_gui_paused ? &profiler_gui_paused_frame : profiler_last_frame();
+
+    if (frame && ImGui::CollapsingHeader("Zones", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const f64 frame_ms = (frame->end_ns - frame->begin_ns) / 1000000.0;
+        ImGui::Text("Frame %llu: %.3f ms", (unsigned long long)frame->index, frame_ms);
+
+        if (ImGui::BeginTable("zones", counters ? 7 : 4, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersV)) {
+            ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed, 70.f);
+            ImGui::TableSetupColumn("% frame", ImGuiTableColumnFlags_WidthFixed, 60.f);
+            ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed, 50.f);
+            if (counters) {
+                ImGui::TableSetupColumn("IPC", ImGuiTableColumnFlags_WidthFixed, 50.f);
+                ImGui::TableSetupColumn("Cache misses", ImGuiTableColumnFlags_WidthFixed, 90.f);
+                ImGui::TableSetupColumn("Branch misses", ImGuiTableColumnFlags_WidthFixed, 90.f);
+            }
+            ImGui::TableHeadersRow();
+
+            if (!frame->nodes.empty()) do_zone_tree(*frame, 0, frame_ms, counters);
+
+            ImGui::EndTable();
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Worst frames")) {
+        do_worst_frames(history);
+    }
+
+    if (ImGui::CollapsingHeader("Locks")) {
+        do_lock_stats();
+    }
+
+    ImGui::End();
+}
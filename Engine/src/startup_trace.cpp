@@ -0,0 +1,97 @@
+#include "pch.h"
+
+#include "startup_trace.h"
+#include "profiler.h"
+#include "logger.h"
+#include "metrics.h"
+#include "json.h"
+
+// Earliest point we can observe without platform specific process start times, runs before main
+const u64 startup_begin_ns = profiler_now_ns();
+
+Startup_Phase startup_phases[MAX_STARTUP_PHASES];
+u32 startup_phase_count = 0;
+
+u32 startup_open_phases[MAX_STARTUP_PHASES];
+bool startup_open_zones[MAX_STARTUP_PHASES];
+u32 startup_depth = 0;
+
+void startup_phase_begin(str_ptr_t name) {
+    const bool zone = _profiler_recording.load(std::memory_order_relaxed);
+    if (zone) _profiler_zone_begin(name);
+
+    if (startup_phase_count >= MAX_STARTUP_PHASES || startup_depth >= MAX_STARTUP_PHASES) {
+        log_warn_once("Startup phase '{}' dropped, only {} phases are recorded", name, MAX_STARTUP_PHASES);
+        if (zone) _profiler_zone_end();
+        return;
+    }
+
+    auto& phase = startup_phases[startup_phase_count];
+    phase.name = name;
+    phase.depth = startup_depth;
+    phase.end_ns = 0;
+
+    startup_open_zones[startup_depth] = zone;
+    startup_open_phases[startup_depth++] = startup_phase_count++;
+
+    phase.begin_ns = profiler_now_ns();
+}
+
+void startup_phase_end() {
+    const u64 end_ns = profiler_now_ns();
+    if (startup_depth == 0) return;
+
+    startup_depth--;
+    startup_phases[startup_open_phases[startup_depth]].end_ns = end_ns;
+    if (startup_open_zones[startup_depth]) _profiler_zone_end();
+}
+
+u32 get_startup_phases(const Startup_Phase** phases) {
+    *phases = startup_phases;
+    return startup_phase_count;
+}
+
+void startup_report(str_ptr_t report_path) {
+    const u64 now_ns = profiler_now_ns();
+    const f64 total_ms = (now_ns - startup_begin_ns) / 1000000.0;
+
+    log_info("Startup took {:.3f} ms", total_ms);
+    for (u32 i = 0; i < startup_phase_count; i++) {
+        const auto& phase = startup_phases[i];
+        const u64 end_ns = phase.end_ns ? phase.end_ns : now_ns;
+        log_info("  {:>9.3f} ms +{:>9.3f} ms  {:{}}{}",
+            (phase.begin_ns - startup_begin_ns) / 1000000.0, (end_ns - phase.begin_ns) / 1000000.0, "", phase.depth * 2, phase.name);
+    }
+
+    if (auto total = get_gauge("startup.ms")) total->set(total_ms);
+
+    if (!report_path) return;
+
+    spdlog::memory_buf_t buf;
+    json_append_raw(buf, "{\"total_ms\":");
+    json_append_number(buf, total_ms);
+    json_append_raw(buf, ",\"phases\":[");
+    for (u32 i = 0; i < startup_phase_count; i++) {
+        const auto& phase = startup_phases[i];
+        const u64 end_ns = phase.end_ns ? phase.end_ns : now_ns;
+        if (i > 0) buf.push_back(',');
+        json_append_raw(buf, "{\"name\":");
+        json_append_string(buf, phase.name);
+        json_append_raw(buf, ",\"depth\":");
+        json_append_number(buf, (u64)phase.depth);
+        json_append_raw(buf, ",\"begin_ms\":");
+        json_append_number(buf, (phase.begin_ns - startup_begin_ns) / 1000000.0);
+        json_append_raw(buf, ",\"duration_ms\":");
+        json_append_number(buf, (end_ns - phase.begin_ns) / 1000000.0);
+        buf.push_back('}');
+    }
+    json_append_raw(buf, "]}\n");
+
+    FILE* file = fopen(report_path, "wb");
+    if (!file) {
+        log_error("Could not write startup report '{}'", report_path);
+        return;
+    }
+    fwrite(buf.data(), 1, buf.size(), file);
+    fclose(file);
+}
@@ -0,0 +1,7 @@
+#include "pch.h"
+
+// stb_image is compiled in this translation unit only, everything else sees the declarations
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#include "stb_image.h"
@@ -0,0 +1,314 @@
+#include "pch.h"
+
+#include "vfs.h"
+#include "pack.h"
+#include "hash.h"
+#include "logger.h"
+#include "profiled_mutex.h"
+
+#include "os/directory_scanner.h"
+
+#include <algorithm>
+#include <filesystem>
+
+struct Vfs_Mount {
+    vfs_mount_t id;
+    path_str_t root;
+    size_t root_length;
+    path_str_t real_path;
+
+    // Either a pack or the files found in the directory at mount time
+    Pack_Archive* pack;
+    std::vector<Dynamic_String> files;
+};
+
+#define VFS_NO_COLLISION 0xFFFFFFFF
+
+struct Vfs_Entry {
+    Vfs_Mount* mount;
+    u32 index;
+
+    // Next entry whose path has the same hash, in vfs_collisions
+    u32 next_collision;
+};
+
+std::vector<Vfs_Mount*> vfs_mounts;
+Hash_Map<u64, Vfs_Entry> vfs_table;
+std::vector<Vfs_Entry> vfs_collisions;
+vfs_mount_t vfs_next_mount_id = 1;
+
+Profiled_Mutex vfs_mutex("vfs");
+
+// Every spelling of a path has to hash the same. Virtual paths are relative to the mounts, so a
+// leading separator is dropped and paths escaping the root are rejected.
+static bool normalize_path(str_ptr_t path, path_str_t out) {
+    if (!os::io::path_normalize(out, path)) return false;
+
+    str_ptr_t start = out;
+    while (*start == '/') start++;
+    if (strcmp(start, ".") == 0) start = "";
+    if (start[0] == '.' && start[1] == '.' && (start[2] == '/' || start[2] == '\0')) return false;
+
+    memmove(out, start, strlen(start) + 1);
+    return true;
+}
+
+static u64 hash_entry_path(const Vfs_Mount& mount, str_ptr_t relative_path) {
+    if (mount.root_length == 0) return fnv1a_64(relative_path);
+    return fnv1a_64(relative_path, fnv1a_64("/", fnv1a_64(mount.root)));
+}
+
+static str_ptr_t get_entry_path(const Vfs_Entry& entry) {
+    if (entry.mount->pack) return entry.mount->pack->get_name(entry.mount->pack->entries[entry.index]);
+    return entry.mount->files[entry.index].c_str();
+}
+
+// Expects path to be normalized
+static bool entry_matches(const Vfs_Entry& entry, str_ptr_t path) {
+    const auto& mount = *entry.mount;
+    if (mount.root_length > 0) {
+        if (strncmp(path, mount.root, mount.root_length) != 0 || path[mount.root_length] != '/') return false;
+        path += mount.root_length + 1;
+    }
+    return strcmp(path, get_entry_path(entry)) == 0;
+}
+
+// Only the same path shadows an earlier entry, different paths with the same hash are chained
+static void add_entry(u64 hash, const Vfs_Entry& entry) {
+    const auto inserted = vfs_table.try_emplace(hash, entry);
+    if (inserted.second) return;
+
+    path_str_t path;
+    const int length = entry.mount->root_length > 0
+        ? snprintf(path, sizeof(path), "%s/%s", entry.mount->root, get_entry_path(entry))
+        : snprintf(path, sizeof(path), "%s", get_entry_path(entry));
+    if (length < 0 || (size_t)length >= sizeof(path)) {
+        log_warn("Skipping '{}', its virtual path is too long", get_entry_path(entry));
+        return;
+    }
+
+    Vfs_Entry* existing = &inserted.first->second;
+    while (true) {
+        if (entry_matches(*existing, path)) {
+            existing->mount = entry.mount;
+            existing->index = entry.index;
+            return;
+        }
+        if (existing->next_collision == VFS_NO_COLLISION) break;
+        existing = &vfs_collisions[existing->next_collision];
+    }
+
+    existing->next_collision = (u32)vfs_collisions.size();
+    vfs_collisions.push_back(entry);
+}
+
+static void add_mount_entries(Vfs_Mount* mount) {
+    if (mount->pack) {
+        for (u32 i = 0; i < mount->pack->entry_count; i++) {
+            const auto name = mount->pack->get_name(mount->pack->entries[i]);
+            add_entry(hash_entry_path(*mount, name), { mount, i, VFS_NO_COLLISION });
+        }
+    } else {
+        for (u32 i = 0; i < (u32)mount->files.size(); i++) {
+            add_entry(hash_entry_path(*mount, mount->files[i].c_str()), { mount, i, VFS_NO_COLLISION });
+        }
+    }
+}
+
+// Expects vfs_mutex to be held and path to be normalized
+static const Vfs_Entry* find_entry(str_ptr_t path) {
+    const auto it = vfs_table.find(fnv1a_64(path));
+    if (it == vfs_table.end()) return NULL;
+
+    // Rule out hash collisions
+    for (const Vfs_Entry* entry = &it->second;; entry = &vfs_collisions[entry->next_collision]) {
+        if (entry_matches(*entry, path)) return entry;
+        if (entry->next_collision == VFS_NO_COLLISION) return NULL;
+    }
+}
+
+vfs_mount_t vfs_mount(str_ptr_t virtual_root, str_ptr_t real_path) {
+    auto mount = new Vfs_Mount();
+    if (!normalize_path(virtual_root, mount->root)) {
+        log_error("Invalid virtual root '{}'", virtual_root);
+        delete mount;
+        return 0;
+    }
+    mount->root_length = strlen(mount->root);
+    strncpy(mount->real_path, real_path, sizeof(mount->real_path) - 1);
+
+    os::io::Dir_Scan scan(real_path, os::io::DIR_SCAN_RECURSIVE | os::io::DIR_SCAN_FILES_ONLY);
+    if (scan._status == os::io::IO_STATUS_OK) {
+        // Symlinked files are mounted, symlinked directories aren't followed
+        mount->files.reserve(scan.entry_count);
+        for (u32 i = 0; i < scan.entry_count; i++) {
+            const auto& entry = scan.entries[i];
+            if (entry.type == os::io::DIR_ENTRY_SYMLINK) {
+                path_str_t target;
+                std::error_code error;
+                if (!os::io::path_join(target, real_path, entry.path) || !std::filesystem::is_regular_file(target, error)) continue;
+            } else if (entry.type != os::io::DIR_ENTRY_FILE) {
+                continue;
+            }
+            mount->files.emplace_back(entry.path, entry.path_length);
+        }
+        if (scan.error_count > 0) log_warn("{} directories under '{}' could not be read", scan.error_count, real_path);
+    } else {
+        mount->pack = new Pack_Archive(real_path);
+        if (mount->pack->_status != os::io::IO_STATUS_OK) {
+            log_error("Could not mount '{}': {}", real_path, os::io::Io_Status_string(mount->pack->_status));
+            delete mount->pack;
+            delete mount;
+            return 0;
+        }
+    }
+
+    std::lock_guard<Profiled_Mutex> lock(vfs_mutex);
+    mount->id = vfs_next_mount_id++;
+    vfs_mounts.push_back(mount);
+    add_mount_entries(mount);
+
+    log_info("Mounted {} '{}' at '{}' ({} files)", mount->pack ? "pack" : "directory", real_path, mount->root,
+        mount->pack ? mount->pack->entry_count : (u32)mount->files.size());
+    return mount->id;
+}
+
+bool vfs_unmount(vfs_mount_t id) {
+    std::lock_guard<Profiled_Mutex> lock(vfs_mutex);
+
+    auto it = std::find_if(vfs_mounts.begin(), vfs_mounts.end(), [id](const Vfs_Mount* mount) { return mount->id == id; });
+    if (it == vfs_mounts.end()) return false;
+
+    delete (*it)->pack;
+    delete *it;
+    vfs_mounts.erase(it);
+
+    // Files the mount shadowed become visible again
+    vfs_table.clear();
+    vfs_collisions.clear();
+    for (auto mount : vfs_mounts) add_mount_entries(mount);
+    return true;
+}
+
+void vfs_unmount_all() {
+    std::lock_guard<Profiled_Mutex> lock(vfs_mutex);
+    for (auto mount : vfs_mounts) {
+        delete mount->pack;
+        delete mount;
+    }
+    vfs_mounts.clear();
+    vfs_table.clear();
+    vfs_collisions.clear();
+}
+
+bool vfs_exists(str_ptr_t path) {
+    path_str_t normalized;
+    if (!normalize_path(path, normalized)) return false;
+
+    std::lock_guard<Profiled_Mutex> lock(vfs_mutex);
+    return find_entry(normalized) != NULL;
+}
+
+Vfs_File vfs_open(str_ptr_t path) {
+    Vfs_File file;
+
+    path_str_t normalized;
+    if (!normalize_path(path, normalized)) {
+        file._status = os::io::IO_STATUS_INVALID_ARGUMENT;
+        return file;
+    }
+
+    const Pack_Archive* pack = NULL;
+    const Pack_Entry* pack_entry = NULL;
+    path_str_t real_path;
+    {
+        std::lock_guard<Profiled_Mutex> lock(vfs_mutex);
+        const Vfs_Entry* entry = find_entry(normalized);
+        if (!entry) {
+            file._status = os::io::IO_STATUS_FILE_NOT_FOUND;
+            return file;
+        }
+
+        if (entry->mount->pack) {
+            pack = entry->mount->pack;
+            pack_entry = &pack->entries[entry->index];
+        } else {
+            const int length = snprintf(real_path, sizeof(real_path), "%s/%s", entry->mount->real_path, entry->mount->files[entry->index].c_str());
+            if (length < 0 || (size_t)length >= sizeof(real_path)) {
+                file._status = os::io::IO_STATUS_INVALID_ARGUMENT;
+                return file;
+            }
+        }
+    }
+
+    if (!pack) {
+        file.__mapping = new os::io::Mapped_File(real_path, os::io::MAPPING_ACCESS_READ_ONLY, os::io::MAPPING_FLAG_SEQUENTIAL);
+        file.data = file.__mapping->data;
+        file.size = file.__mapping->size;
+        file._status = file.__mapping->_status;
+        return file;
+    }
+
+    file.size = pack_entry->size;
+    if (!(pack_entry->flags & PACK_ENTRY_FLAG_LZ4)) {
+        file.data = pack->get_data(*pack_entry);
+        file._status = os::io::IO_STATUS_OK;
+        return file;
+    }
+
+    file.__buffer = (byte_t*)malloc(pack_entry->size ? pack_entry->size : 1);
+    if (!file.__buffer) {
+        file._status = os::io::IO_STATUS_OUT_OF_MEMORY;
+    } else if (!pack->read(*pack_entry, file.__buffer)) {
+        file._status = os::io::IO_STATUS_INVALID_FORMAT;
+    } else {
+        file.data = file.__buffer;
+        file._status = os::io::IO_STATUS_OK;
+    }
+    return file;
+}
+
+bool vfs_resolve(str_ptr_t path, path_str_t real_path) {
+    path_str_t normalized;
+    if (!normalize_path(path, normalized)) return false;
+
+    std::lock_guard<Profiled_Mutex> lock(vfs_mutex);
+    const Vfs_Entry* entry = find_entry(normalized);
+    if (!entry || entry->mount->pack) return false;
+
+    const int length = snprintf(real_path, sizeof(path_str_t), "%s/%s", entry->mount->real_path, entry->mount->files[entry->index].c_str());
+    return length >= 0 && (size_t)length < sizeof(path_str_t);
+}
+
+u32 vfs_file_count() {
+    std::lock_guard<Profiled_Mutex> lock(vfs_mutex);
+    return (u32)(vfs_table.size() + vfs_collisions.size());
+}
+
+Vfs_File::Vfs_File(Vfs_File&& other) {
+    *this = std::move(other);
+}
+
+Vfs_File& Vfs_File::operator=(Vfs_File&& other) {
+    if (this == &other) return *this;
+    delete __mapping;
+    free(__buffer);
+
+    data = other.data;
+    size = other.size;
+    _status = other._status;
+    __mapping = other.__mapping;
+    __buffer = other.__buffer;
+
+    other.data = NULL;
+    other.size = 0;
+    other._status = os::io::IO_STATUS_UNSET;
+    other.__mapping = NULL;
+    other.__buffer = NULL;
+    return *this;
+}
+
+Vfs_File::~Vfs_File() {
+    delete __mapping;
+    free(__buffer);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// Opt-in allocation profiler for the Launcher process (premake5 --alloc-profiler).
+// On Linux malloc/free are interposed for the whole process, so Engine, modules and the C++
+// runtime are all counted. On Windows only operator new/delete of the Launcher are replaced.
+
+struct Alloc_Frame_Stats {
+    u64 allocations;
+    u64 bytes;
+    u64 frees;
+};
+
+#ifdef _ST_ALLOC_PROFILER
+
+// Records the call stack of every sample_rate-th allocation per thread, 0 only counts
+void init_alloc_profiler(u32 sample_rate);
+
+// Logs the frame's totals and top allocating call sites on the "alloc" channel and resets them
+Alloc_Frame_Stats alloc_profiler_frame_end();
+
+#else
+
+inline void init_alloc_profiler(u32) {}
+inline Alloc_Frame_Stats alloc_profiler_frame_end() { return {}; }
+
+#endif
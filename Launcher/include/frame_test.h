@@ -0,0 +1,34 @@
+#pragma once
+
+#include "os/modules.h"
+
+// Headless frame time regression test: runs a module for a fixed number of frames with a fixed
+// delta time, then compares p50/p99/max frame times against a baseline file.
+
+struct Frame_Test_Config {
+    u32 frames = 1000;
+    u32 warmup_frames = 60;
+    f32 delta_time = 1.f / 60.f;
+
+    str_ptr_t baseline_path = NULL;
+    bool write_baseline = false;
+
+    // Allowed slowdown relative to the baseline, max is much noisier than the percentiles
+    f64 tolerance = 0.10;
+    f64 max_tolerance = 0.50;
+};
+
+struct Frame_Test_Result {
+    f64 p50_ms;
+    f64 p99_ms;
+    f64 max_ms;
+};
+
+enum Frame_Test_Status : s8 {
+    FRAME_TEST_PASSED = 0,
+    FRAME_TEST_REGRESSED = 1,
+    FRAME_TEST_ERROR = 2,
+};
+
+// The module must already be initialized. The status doubles as the process exit code.
+Frame_Test_Status run_frame_test(os::Module& module, const Frame_Test_Config& config);
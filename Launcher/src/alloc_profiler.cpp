@@ -0,0 +1,308 @@
+#include "pch.h"
+
+#include "alloc_profiler.h"
+
+#ifdef _ST_ALLOC_PROFILER
+
+#include "Engine/logger.h"
+
+#include <atomic>
+#include <errno.h>
+
+#ifdef _ST_OS_LINUX
+    #include <execinfo.h>
+    #include <dlfcn.h>
+#else
+    #include "Windows.h"
+#endif
+
+#define ALLOC_MAX_STACK_DEPTH 16
+#define ALLOC_SITE_CAPACITY 4096
+#define ALLOC_REPORT_TOP_SITES 10
+
+struct Alloc_Site {
+    u64 hash;
+    u32 depth;
+    void* frames[ALLOC_MAX_STACK_DEPTH];
+    u64 count;
+    u64 bytes;
+};
+
+// Everything is statically allocated and zero initialized, the allocator hooks run before main
+std::atomic<u64> alloc_count = 0;
+std::atomic<u64> alloc_bytes = 0;
+std::atomic<u64> free_count = 0;
+
+std::atomic<u32> alloc_sample_rate = 0;
+
+Alloc_Site alloc_sites[ALLOC_SITE_CAPACITY];
+u32 alloc_site_count = 0;
+std::atomic_flag alloc_sites_lock = ATOMIC_FLAG_INIT;
+
+thread_local u32 alloc_sample_counter = 0;
+thread_local bool alloc_in_profiler = false;
+
+log_channel_t alloc_log = LOG_CHANNEL_INVALID;
+u64 alloc_frame_index = 0;
+
+static u64 hash_stack(void* const* frames, u32 depth) {
+    u64 hash = 14695981039346656037ull;
+    for (u32 i = 0; i < depth; i++) {
+        hash ^= (u64)frames[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static void record_site(size_t size) {
+    void* stack[ALLOC_MAX_STACK_DEPTH];
+#ifdef _ST_OS_LINUX
+    const int captured = backtrace(stack, ALLOC_MAX_STACK_DEPTH);
+#else
+    const int captured = (int)CaptureStackBackTrace(0, ALLOC_MAX_STACK_DEPTH, stack, NULL);
+#endif
+    if (captured <= 0) return;
+
+    const u32 depth = (u32)captured;
+    const u64 hash = hash_stack(stack, depth);
+
+    while (alloc_sites_lock.test_and_set(std::memory_order_acquire)) {}
+
+    // Open addressing, sites which don't fit once the table is full are dropped
+    for (u32 probe = 0; probe < ALLOC_SITE_CAPACITY; probe++) {
+        auto& site = alloc_sites[(hash + probe) % ALLOC_SITE_CAPACITY];
+        if (site.count == 0) {
+            if (alloc_site_count >= ALLOC_SITE_CAPACITY * 3 / 4) break;
+            site.hash = hash;
+            site.depth = depth;
+            memcpy(site.frames, stack, depth * sizeof(void*));
+            alloc_site_count++;
+        } else if (site.hash != hash) {
+            continue;
+        }
+        site.count++;
+        site.bytes += size;
+        break;
+    }
+
+    alloc_sites_lock.clear(std::memory_order_release);
+}
+
+static void on_alloc(size_t size) {
+    if (alloc_in_profiler) return;
+
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    const u32 rate = alloc_sample_rate.load(std::memory_order_relaxed);
+    if (rate == 0 || ++alloc_sample_counter < rate) return;
+    alloc_sample_counter = 0;
+
+    // Stack capture may allocate itself
+    alloc_in_profiler = true;
+    record_site(size);
+    alloc_in_profiler = false;
+}
+
+static void on_free(void* ptr) {
+    if (ptr && !alloc_in_profiler) free_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void init_alloc_profiler(u32 sample_rate) {
+    alloc_in_profiler = true;
+#ifdef _ST_OS_LINUX
+    // The first backtrace() loads libgcc, get that out of the way before sampling starts
+    void* warmup[1];
+    backtrace(warmup, 1);
+#endif
+    alloc_log = register_log_channel("alloc");
+    alloc_in_profiler = false;
+
+    alloc_sample_rate.store(sample_rate, std::memory_order_relaxed);
+}
+
+static void describe_frame(void* address, char* out, size_t out_size) {
+#ifdef _ST_OS_LINUX
+    Dl_info info;
+    if (dladdr(address, &info) && info.dli_fname) {
+        str_ptr_t module = strrchr(info.dli_fname, '/');
+        module = module ? module + 1 : info.dli_fname;
+        if (info.dli_sname) snprintf(out, out_size, "%s!%s+0x%zx", module, info.dli_sname, (size_t)((char*)address - (char*)info.dli_saddr));
+        else snprintf(out, out_size, "%s+0x%zx", module, (size_t)((char*)address - (char*)info.dli_fbase));
+        return;
+    }
+#else
+    HMODULE module = NULL;
+    if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)address, &module)) {
+        path_str_t module_path = "";
+        GetModuleFileNameA(module, module_path, sizeof(module_path));
+        str_ptr_t name = strrchr(module_path, '\\');
+        snprintf(out, out_size, "%s+0x%zx", name ? name + 1 : module_path, (size_t)((char*)address - (char*)module));
+        return;
+    }
+#endif
+    snprintf(out, out_size, "%p", address);
+}
+
+// Index of the first frame after the profiler and the allocator entry points (malloc, operator new, ...)
+static u32 find_call_site(const Alloc_Site& site) {
+#ifdef _ST_OS_LINUX
+    static str_ptr_t entry_points[] = { "malloc", "calloc", "realloc", "memalign", "aligned_alloc", "posix_memalign" };
+
+    u32 call_site = 0;
+    for (u32 i = 0; i < site.depth; i++) {
+        Dl_info info;
+        if (!dladdr(site.frames[i], &info) || !info.dli_sname) continue;
+
+        bool is_entry_point = strncmp(info.dli_sname, "_Zn", 3) == 0; // operator new/new[]
+        for (auto name : entry_points) {
+            if (strcmp(info.dli_sname, name) == 0) is_entry_point = true;
+        }
+        if (is_entry_point) call_site = i + 1;
+    }
+    return call_site < site.depth ? call_site : site.depth - 1;
+#else
+    // record_site, on_alloc, operator new
+    return site.depth > 3 ? 3 : site.depth - 1;
+#endif
+}
+
+Alloc_Frame_Stats alloc_profiler_frame_end() {
+    const Alloc_Frame_Stats stats = {
+        alloc_count.exchange(0, std::memory_order_relaxed),
+        alloc_bytes.exchange(0, std::memory_order_relaxed),
+        free_count.exchange(0, std::memory_order_relaxed),
+    };
+
+    alloc_in_profiler = true;
+
+    Alloc_Site top[ALLOC_REPORT_TOP_SITES];
+    u32 top_count = 0;
+
+    while (alloc_sites_lock.test_and_set(std::memory_order_acquire)) {}
+    for (const auto& site : alloc_sites) {
+        if (site.count == 0) continue;
+
+        u32 slot = top_count < ALLOC_REPORT_TOP_SITES ? top_count : ALLOC_REPORT_TOP_SITES - 1;
+        if (top_count == ALLOC_REPORT_TOP_SITES && site.count <= top[slot].count) continue;
+        while (slot > 0 && top[slot - 1].count < site.count) {
+            top[slot] = top[slot - 1];
+            slot--;
+        }
+        top[slot] = site;
+        if (top_count < ALLOC_REPORT_TOP_SITES) top_count++;
+    }
+    memset(alloc_sites, 0, sizeof(alloc_sites));
+    alloc_site_count = 0;
+    alloc_sites_lock.clear(std::memory_order_release);
+
+    if (_log_channel_enabled(alloc_log, spdlog::level::info)) {
+        log_info_ch(alloc_log, "Frame {}: {} allocations ({} bytes), {} frees", alloc_frame_index, stats.allocations, stats.bytes, stats.frees);
+
+        const u32 rate = alloc_sample_rate.load(std::memory_order_relaxed);
+        for (u32 i = 0; i < top_count; i++) {
+            const u32 call_site = find_call_site(top[i]);
+
+            str256_t caller;
+            describe_frame(top[i].frames[call_site], caller, sizeof(caller));
+            log_info_ch(alloc_log, "  ~{} allocations, ~{} bytes from {}", top[i].count * rate, top[i].bytes * rate, caller);
+
+            for (u32 frame = call_site + 1; frame < top[i].depth && frame < call_site + 5; frame++) {
+                describe_frame(top[i].frames[frame], caller, sizeof(caller));
+                log_debug_ch(alloc_log, "      {}", caller);
+            }
+        }
+    }
+
+    alloc_in_profiler = false;
+    alloc_frame_index++;
+    return stats;
+}
+
+// Hooks
+
+#ifdef _ST_OS_LINUX
+
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void  __libc_free(void* ptr);
+
+    // Defined in the executable, these take precedence over libc for every loaded module
+    void* malloc(size_t size) {
+        on_alloc(size);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) {
+        on_alloc(count * size);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* ptr, size_t size) {
+        on_alloc(size);
+        on_free(ptr);
+        return __libc_realloc(ptr, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) {
+        on_alloc(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) {
+        on_alloc(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** out, size_t alignment, size_t size) {
+        on_alloc(size);
+        *out = __libc_memalign(alignment, size);
+        return *out ? 0 : ENOMEM;
+    }
+
+    void free(void* ptr) {
+        on_free(ptr);
+        __libc_free(ptr);
+    }
+}
+
+#else
+
+void* operator new(size_t size) {
+    on_alloc(size);
+    if (void* ptr = malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    on_alloc(size);
+    if (void* ptr = malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    on_free(ptr);
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    on_free(ptr);
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    on_free(ptr);
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    on_free(ptr);
+    free(ptr);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+#include "pch.h"
+
+#include "frame_test.h"
+#include "alloc_profiler.h"
+
+#include "os/atomic_writer.h"
+
+#include "Engine/logger.h"
+#include "Engine/profiler.h"
+#include "Engine/metrics.h"
+
+#include <algorithm>
+
+static f64 percentile(const std::vector<f64>& sorted, f64 p) {
+    const size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index < sorted.size() ? index : sorted.size() - 1];
+}
+
+static bool read_baseline(str_ptr_t path, Frame_Test_Result* baseline) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    *baseline = {};
+    u32 found = 0;
+
+    str64_t key;
+    f64 value;
+    while (fscanf(file, "%63s %lf", key, &value) == 2) {
+        if (strcmp(key, "p50_ms") == 0)      { baseline->p50_ms = value; found |= BIT1; }
+        else if (strcmp(key, "p99_ms") == 0) { baseline->p99_ms = value; found |= BIT2; }
+        else if (strcmp(key, "max_ms") == 0) { baseline->max_ms = value; found |= BIT3; }
+    }
+    fclose(file);
+
+    return found == (BIT1 | BIT2 | BIT3);
+}
+
+static bool write_baseline(str_ptr_t path, const Frame_Test_Result& result, const Frame_Test_Config& config) {
+    // Written atomically so an interrupted run can't leave a truncated baseline behind
+    char buf[256];
+    const int length = snprintf(buf, sizeof(buf), "p50_ms %.6f\np99_ms %.6f\nmax_ms %.6f\nframes %u\ndelta_time %.6f\n",
+        result.p50_ms, result.p99_ms, result.max_ms, config.frames, config.delta_time);
+    if (length < 0 || (size_t)length >= sizeof(buf)) return false;
+
+    return os::io::write_file_atomic(path, buf, (size_t)length) == os::io::IO_STATUS_OK;
+}
+
+static bool check_metric(str_ptr_t name, f64 value, f64 baseline, f64 tolerance) {
+    const f64 limit = baseline * (1.0 + tolerance);
+    const bool ok = value <= limit;
+    if (ok) {
+        log_info("  {}: {:.4f} ms (baseline {:.4f} ms, limit {:.4f} ms)", name, value, baseline, limit);
+    } else {
+        log_error("  {}: {:.4f} ms exceeds the limit of {:.4f} ms (baseline {:.4f} ms, +{:.1f}%)", name, value, limit, baseline, (value / baseline - 1.0) * 100.0);
+    }
+    return ok;
+}
+
+Frame_Test_Status run_frame_test(os::Module& module, const Frame_Test_Config& config) {
+    if (config.frames == 0) {
+        log_error("Frame test needs at least one frame");
+        return FRAME_TEST_ERROR;
+    }
+
+    std::vector<f64> frame_ms;
+    frame_ms.reserve(config.frames);
+
+    log_info("Running frame test: {} frames (+{} warmup) at a fixed delta time of {} s", config.frames, config.warmup_frames, config.delta_time);
+
+    for (u32 frame = 0; frame < config.warmup_frames + config.frames; frame++) {
+        const u64 begin = profiler_now_ns();
+        {
+            st_profile_scope_named("Module update");
+            module.update(config.delta_time);
+        }
+        const u64 end = profiler_now_ns();
+
+        const f64 ms = (end - begin) / 1000000.0;
+        if (frame >= config.warmup_frames) frame_ms.push_back(ms);
+
+        profiler_frame_mark();
+#ifdef _ST_ALLOC_PROFILER
+        const Alloc_Frame_Stats alloc_stats = alloc_profiler_frame_end();
+        st_gauge_set("frame.allocations", (f64)alloc_stats.allocations);
+        st_gauge_set("frame.allocated_bytes", (f64)alloc_stats.bytes);
+#endif
+
+        st_histogram_record("frame.ms", ms);
+        metrics_frame_end();
+    }
+
+    std::sort(frame_ms.begin(), frame_ms.end());
+    const Frame_Test_Result result = { percentile(frame_ms, 0.50), percentile(frame_ms, 0.99), frame_ms.back() };
+
+    log_info("Frame test result: p50 {:.4f} ms, p99 {:.4f} ms, max {:.4f} ms", result.p50_ms, result.p99_ms, result.max_ms);
+
+    if (!config.baseline_path) {
+        if (!config.write_baseline) return FRAME_TEST_PASSED;
+        log_error("No frame test baseline path to write to");
+        return FRAME_TEST_ERROR;
+    }
+
+    if (config.write_baseline) {
+        if (!write_baseline(config.baseline_path, result, config)) {
+            log_error("Could not write frame test baseline '{}'", config.baseline_path);
+            return FRAME_TEST_ERROR;
+        }
+        log_info("Wrote frame test baseline '{}'", config.baseline_path);
+        return FRAME_TEST_PASSED;
+    }
+
+    Frame_Test_Result baseline;
+    if (!read_baseline(config.baseline_path, &baseline)) {
+        log_error("Could not read frame test baseline '{}'", config.baseline_path);
+        return FRAME_TEST_ERROR;
+    }
+
+    log_info("Comparing against baseline '{}':", config.baseline_path);
+    bool ok = true;
+    ok &= check_metric("p50", result.p50_ms, baseline.p50_ms, config.tolerance);
+    ok &= check_metric("p99", result.p99_ms, baseline.p99_ms, config.tolerance);
+    ok &= check_metric("max", result.max_ms, baseline.max_ms, config.max_tolerance);
+
+    if (!ok) log_error("Frame test regressed");
+    return ok ? FRAME_TEST_PASSED : FRAME_TEST_REGRESSED;
+}
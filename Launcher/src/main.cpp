@@ -1,9 +1,18 @@
 #include "pch.h"
 #include "os/modules.h"
 #include "os/io.h"
+#include "os/crash.h"
+#include "os/sampler.h"
+
+#include "alloc_profiler.h"
+#include "frame_test.h"
 
 
 #include "Engine/logger.h"
+#include "Engine/profiler.h"
+#include "Engine/metrics.h"
+#include "Engine/startup_trace.h"
+#include "Engine/asset_cache.h"
 
 /*
 DO
@@ -14,18 +23,153 @@ Som kind of module list generated in build time
 
 */
 
+static void print_usage() {
+	printf(
+		"Usage: Launcher [options]\n"
+		"  --module <name>         Module to load (default Sandbox)\n"
+		"  --frame-test <frames>   Run the module headless for a number of frames and report frame times\n"
+		"  --warmup <frames>       Frames to run before measuring (default 60)\n"
+		"  --delta <seconds>       Fixed delta time passed to update (default 1/60)\n"
+		"  --baseline <path>       Compare the frame test against this baseline\n"
+		"  --write-baseline        Write the frame test result to --baseline instead\n"
+		"  --tolerance <percent>   Allowed p50/p99 regression (default 10)\n"
+		"  --max-tolerance <pct>   Allowed max frame time regression (default 50)\n");
+}
+
 std::ofstream log_stream;
-int main(/*char** argv, int argc*/) {
-	log_stream.open("output");
-	init_logger(log_stream);
+int main(int argc, char** argv) {
+	str_ptr_t module_name = "Sandbox";
+	bool frame_test = false;
+	Frame_Test_Config frame_test_config;
+
+	for (int i = 1; i < argc; i++) {
+		str_ptr_t arg = argv[i];
+		str_ptr_t value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(arg, "--write-baseline") == 0) {
+			frame_test_config.write_baseline = true;
+			continue;
+		}
+		if (!value) {
+			print_usage();
+			return FRAME_TEST_ERROR;
+		}
+
+		if (strcmp(arg, "--module") == 0) {
+			module_name = value;
+		} else if (strcmp(arg, "--frame-test") == 0) {
+			frame_test = true;
+			frame_test_config.frames = (u32)atoi(value);
+		} else if (strcmp(arg, "--warmup") == 0) {
+			frame_test_config.warmup_frames = (u32)atoi(value);
+		} else if (strcmp(arg, "--delta") == 0) {
+			frame_test_config.delta_time = (f32)atof(value);
+		} else if (strcmp(arg, "--baseline") == 0) {
+			frame_test_config.baseline_path = value;
+		} else if (strcmp(arg, "--tolerance") == 0) {
+			frame_test_config.tolerance = atof(value) / 100.0;
+		} else if (strcmp(arg, "--max-tolerance") == 0) {
+			frame_test_config.max_tolerance = atof(value) / 100.0;
+		} else {
+			print_usage();
+			return FRAME_TEST_ERROR;
+		}
+		i++;
+	}
+	if (frame_test_config.write_baseline && !frame_test_config.baseline_path) {
+		printf("--write-baseline needs --baseline <path>\n");
+		print_usage();
+		return FRAME_TEST_ERROR;
+	}
+
+	startup_phase_begin("Startup");
+
+	{
+		st_startup_scope("init_logger");
+		log_stream.open("output");
+		init_logger(log_stream);
+	}
+	{
+		st_startup_scope("Crash handlers");
+		os::install_crash_handlers("crash.log");
+	}
+
+	str_ptr_t alloc_sample_rate = getenv("ST_ALLOC_SAMPLE_RATE");
+	init_alloc_profiler(alloc_sample_rate ? (u32)atoi(alloc_sample_rate) : 64);
+
+	profiler_set_thread_name("Main");
+	str_ptr_t trace_path = getenv("ST_PROFILE_TRACE");
+	if (trace_path) profiler_begin_session();
+
+	str_ptr_t sample_path = getenv("ST_SAMPLE");
+	if (sample_path) {
+		str_ptr_t sample_hz = getenv("ST_SAMPLE_HZ");
+		os::sampler_register_thread("Main");
+		if (!os::sampler_start(sample_hz ? (u32)atoi(sample_hz) : 997)) sample_path = NULL;
+	}
+
+	str_ptr_t metrics_path = getenv("ST_METRICS");
+	if (metrics_path) {
+		str_ptr_t metrics_interval = getenv("ST_METRICS_INTERVAL");
+		init_metrics(metrics_path, metrics_interval ? (u32)atoi(metrics_interval) : 60);
+	}
 	
-	path_str_t sandbox_path = "";
-	sprintf(sandbox_path, "%s/%s", os::io::get_exe_dir().str, "Sandbox.dll");
-	os::Module test_mod(sandbox_path);
+	path_str_t module_path = "";
+	{
+		st_startup_scope("get_exe_dir");
+		snprintf(module_path, sizeof(module_path), "%s/%s%s.%s", os::io::get_cached_exe_dir(), MODULE_FILE_PREFIX, module_name, MODULE_FILE_EXTENSION);
+	}
+	{
+		st_startup_scope("Asset cache");
+		path_str_t asset_cache_path = "";
+		str_ptr_t asset_cache_override = getenv("ST_ASSET_CACHE");
+		if (asset_cache_override) snprintf(asset_cache_path, sizeof(asset_cache_path), "%s", asset_cache_override);
+		else snprintf(asset_cache_path, sizeof(asset_cache_path), "%s/asset_cache", os::io::get_cached_exe_dir());
+		init_asset_cache(asset_cache_path);
+	}
+
+	startup_phase_begin("dlopen module");
+	os::Module test_mod(module_path);
+	startup_phase_end();
+
+	if (test_mod._status != os::MODULE_STATUS_OK) {
+		log_critical("Could not load module '{}': {}", module_path, os::Module_Status_string(test_mod._status));
+		startup_phase_end();
+		startup_report(getenv("ST_STARTUP_REPORT"));
+		return FRAME_TEST_ERROR;
+	}
+
+	{
+		st_startup_scope("Module init");
+		test_mod.init();
+	}
+
+	startup_phase_end();
+	startup_report(getenv("ST_STARTUP_REPORT"));
 
-	test_mod.init();
+	int exit_code = 0;
+	if (frame_test) {
+		exit_code = run_frame_test(test_mod, frame_test_config);
+	} else {
+		{
+			st_profile_scope_named("Module update");
+			test_mod.update(5);
+		}
+#ifdef _ST_ALLOC_PROFILER
+		const Alloc_Frame_Stats alloc_stats = alloc_profiler_frame_end();
+		st_gauge_set("frame.allocations", (f64)alloc_stats.allocations);
+		st_gauge_set("frame.allocated_bytes", (f64)alloc_stats.bytes);
+#endif
+		metrics_frame_end();
+	}
 
-	test_mod.update(5);
+	if (trace_path) profiler_end_session(trace_path);
+	if (sample_path) {
+		// Before the module unloads so its symbols can still be resolved
+		os::sampler_stop();
+		os::sampler_write_folded(sample_path);
+	}
+	if (metrics_path) shutdown_metrics();
 
-	return 0;
-}
\ No newline at end of file
+	return exit_code;
+}
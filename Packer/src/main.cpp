@@ -0,0 +1,181 @@
+#include "pch.h"
+
+#include "os/io.h"
+
+#include "Engine/pack.h"
+#include "Engine/hash.h"
+#include "Engine/lz4.h"
+
+#include <algorithm>
+#include <filesystem>
+
+// Builds pack archives (Engine/pack.h) from a directory
+
+struct Packer_Config {
+    str_ptr_t input_dir = NULL;
+    str_ptr_t output_path = NULL;
+    bool compress = true;
+
+    // Entries are only stored compressed when that saves at least this much
+    f64 min_saving = 0.10;
+};
+
+struct Packer_Entry {
+    Dynamic_String path;
+    Pack_Entry entry;
+};
+
+static void print_usage() {
+    printf(
+        "Usage: Packer <input directory> <output pack> [options]\n"
+        "  --no-compress         Store every file uncompressed\n"
+        "  --min-saving <pct>    Only compress files that shrink by at least pct (default 10)\n");
+}
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool write_pack(const Packer_Config& config) {
+    std::vector<Packer_Entry> entries;
+
+    // A pack written into its own input directory must not pack the previous build of itself
+    std::error_code output_error;
+    const std::filesystem::path output_path = std::filesystem::weakly_canonical(config.output_path, output_error);
+
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(config.input_dir, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file(error)) continue;
+
+        std::error_code canonical_error;
+        if (!output_error && std::filesystem::weakly_canonical(it->path(), canonical_error) == output_path) continue;
+
+        Packer_Entry entry = {};
+        entry.path = std::filesystem::relative(it->path(), config.input_dir, error).generic_string();
+        entries.push_back(std::move(entry));
+    }
+    if (error) {
+        fprintf(stderr, "Could not list '%s': %s\n", config.input_dir, error.message().c_str());
+        return false;
+    }
+
+    // Deterministic output for the same input
+    std::sort(entries.begin(), entries.end(), [](const Packer_Entry& a, const Packer_Entry& b) { return a.path < b.path; });
+
+    os::io::File output(config.output_path, os::io::FILE_ACCESS_WRITE, os::io::FILE_FLAG_CREATE | os::io::FILE_FLAG_TRUNCATE);
+    if (output._status != os::io::IO_STATUS_OK) {
+        fprintf(stderr, "Could not open '%s': %s\n", config.output_path, os::io::Io_Status_string(output._status));
+        return false;
+    }
+
+    std::vector<byte_t> compressed;
+    std::vector<char> names;
+    u64 cursor = PACK_ALIGNMENT;
+    u64 total_size = 0;
+    u64 total_stored = 0;
+
+    for (auto& entry : entries) {
+        path_str_t source_path;
+        snprintf(source_path, sizeof(source_path), "%s/%s", config.input_dir, entry.path.c_str());
+
+        os::io::Mapped_File source(source_path, os::io::MAPPING_ACCESS_READ_ONLY, os::io::MAPPING_FLAG_SEQUENTIAL);
+        if (source._status != os::io::IO_STATUS_OK) {
+            fprintf(stderr, "Could not read '%s': %s\n", source_path, os::io::Io_Status_string(source._status));
+            return false;
+        }
+
+        const byte_t* stored = source.data;
+        entry.entry.size = source.size;
+        entry.entry.stored_size = source.size;
+        entry.entry.flags = PACK_ENTRY_FLAG_NONE;
+
+        if (config.compress && source.size > 0) {
+            compressed.resize(lz4_compress_bound(source.size));
+            const size_t compressed_size = lz4_compress(source.data, source.size, compressed.data(), compressed.size());
+            if (compressed_size > 0 && compressed_size <= source.size * (1.0 - config.min_saving)) {
+                stored = compressed.data();
+                entry.entry.stored_size = compressed_size;
+                entry.entry.flags = PACK_ENTRY_FLAG_LZ4;
+            }
+        }
+
+        entry.entry.path_hash = fnv1a_64(entry.path.c_str());
+        entry.entry.offset = cursor;
+        entry.entry.name_offset = (u32)names.size();
+        entry.entry.name_length = (u32)entry.path.size();
+        names.insert(names.end(), entry.path.c_str(), entry.path.c_str() + entry.path.size() + 1);
+
+        if (output.write_at(stored, entry.entry.stored_size, cursor) != (s64)entry.entry.stored_size) {
+            fprintf(stderr, "Could not write '%s'\n", config.output_path);
+            return false;
+        }
+        cursor = align_up(cursor + entry.entry.stored_size, PACK_ALIGNMENT);
+
+        total_size += entry.entry.size;
+        total_stored += entry.entry.stored_size;
+    }
+
+    std::vector<Pack_Entry> index;
+    index.reserve(entries.size());
+    for (const auto& entry : entries) index.push_back(entry.entry);
+    std::stable_sort(index.begin(), index.end(), [](const Pack_Entry& a, const Pack_Entry& b) { return a.path_hash < b.path_hash; });
+
+    Pack_Header header = {};
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.entry_count = (u32)index.size();
+    header.alignment = PACK_ALIGNMENT;
+    // Without entries there's no data to place the index after, it follows the header
+    header.index_offset = index.empty() ? align_up(sizeof(Pack_Header), alignof(Pack_Entry)) : cursor;
+    header.names_offset = header.index_offset + index.size() * sizeof(Pack_Entry);
+    header.names_size = names.size();
+
+    const u64 index_size = index.size() * sizeof(Pack_Entry);
+    if (output.write_at(index.data(), index_size, header.index_offset) != (s64)index_size
+        || output.write_at(names.data(), names.size(), header.names_offset) != (s64)names.size()
+        || output.write_at(&header, sizeof(header), 0) != (s64)sizeof(header)) {
+        fprintf(stderr, "Could not write '%s'\n", config.output_path);
+        return false;
+    }
+
+    printf("Packed %zu files into '%s': %llu -> %llu bytes (%llu bytes with alignment and index)\n",
+        entries.size(), config.output_path, (unsigned long long)total_size, (unsigned long long)total_stored,
+        (unsigned long long)(header.names_offset + header.names_size));
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Packer_Config config;
+
+    for (int i = 1; i < argc; i++) {
+        str_ptr_t arg = argv[i];
+        str_ptr_t value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--help") == 0) {
+            print_usage();
+            return 0;
+        } else if (strcmp(arg, "--no-compress") == 0) {
+            config.compress = false;
+        } else if (strcmp(arg, "--min-saving") == 0 && value) {
+            config.min_saving = atof(value) / 100.0;
+            i++;
+        } else if (arg[0] == '-') {
+            print_usage();
+            return 1;
+        } else if (!config.input_dir) {
+            config.input_dir = arg;
+        } else if (!config.output_path) {
+            config.output_path = arg;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (!config.input_dir || !config.output_path) {
+        print_usage();
+        return 1;
+    }
+
+    return write_pack(config) ? 0 : 1;
+}
@@ -2,14 +2,18 @@
 
 #include <Engine/logger.h>
 
+log_channel_t sandbox_log = LOG_CHANNEL_INVALID;
+
 export_function(int) init() {
-    log_error("SANDBOX INIT");
+    sandbox_log = register_log_channel("module:Sandbox");
+
+    log_error_ch(sandbox_log, "SANDBOX INIT");
 
     return 0;
 }
 
 export_function(int) update(float delta_time) {
-    log_warn("SANDBOX UPDATE {}", (double)delta_time);
+    log_warn_every_ms(1000, "SANDBOX UPDATE {}", (double)delta_time);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -12,7 +12,7 @@ function stallout_project(name)
     includedirs {
         "%{prj.location}/include",
         "deps/mz",
-        "deps/imgui",
+        "deps/dearimgui",
         "deps/spdlog/include",
     }
     files { "%{prj.location}/src/**.cpp", "%{prj.location}/include/**.h" }
@@ -25,6 +25,11 @@ function stallout_project(name)
     pchsource "%{prj.location}/src/pch.cpp"
 end
 
+newoption {
+    trigger     = "alloc-profiler",
+    description = "Interpose malloc/free in the Launcher to profile allocations per frame"
+}
+
 workspace "Stallout"  
     configurations { "Debug", "Test", "Release" } 
 
@@ -67,6 +72,9 @@ workspace "Stallout"
     filter "system:linux"
         pic "On"
         defines { "_ST_OS_LINUX" }
+        linkoptions { "-rdynamic" }
+        -- The sampler (os/sampler.h) unwinds through frame pointers
+        buildoptions { "-fno-omit-frame-pointer" }
 
     filter "action:vs*"
         buildoptions { "/wd4201", "/wd26495" }
@@ -86,11 +94,22 @@ workspace "Stallout"
             "{COPY} %{wks.location}deps/openal/lib/%{cfg.buildcfg}/OpenAL32.dll %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Launcher/"
         }
 
+        filter "options:alloc-profiler"
+            defines { "_ST_ALLOC_PROFILER" }
+
+        filter "system:linux"
+            links { "dl" }
+
     stallout_project "Engine"
         kind "SharedLib"
 
+        -- Every executable linking Engine needs the binary next to it
         postbuildcommands {
-            "{COPY} %{cfg.buildtarget.relpath} %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Launcher//"
+            "{COPY} %{cfg.buildtarget.relpath} %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Launcher//",
+            "{MKDIR} %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Bench",
+            "{COPY} %{cfg.buildtarget.relpath} %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Bench/",
+            "{MKDIR} %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Packer",
+            "{COPY} %{cfg.buildtarget.relpath} %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Packer/"
         }
 
         defines {
@@ -140,6 +159,11 @@ workspace "Stallout"
         filter "system:linux"
             pic "On"
 
+            files {
+                "%{prj.location}/include/os/linux/*.h",
+                "%{prj.location}/src/os/linux/*.cpp"
+            }
+
             links {
                 "GL",
                 "GLU",
@@ -149,6 +173,7 @@ workspace "Stallout"
                 "pthread",
                 "Xi",
                 "dl",
+                "rt",
                 "stdc++fs",
             }
 
@@ -181,6 +206,34 @@ workspace "Stallout"
             "{COPY} %{cfg.buildtarget.relpath} %{wks.location}bin/%{cfg.buildcfg}/%{wks.name}/Launcher/"
         }
 
+    stallout_project "Bench"
+        kind "ConsoleApp"
+
+        includedirs {
+            "Engine/include"
+        }
+
+        links {
+            "Engine"
+        }
+
+        filter "system:linux"
+            links { "pthread" }
+
+    stallout_project "Packer"
+        kind "ConsoleApp"
+
+        includedirs {
+            "Engine/include"
+        }
+
+        links {
+            "Engine"
+        }
+
+        filter "system:linux"
+            links { "pthread" }
+
     project "glfw"
         location   "deps/glfw"
         kind       "StaticLib"